@@ -0,0 +1,285 @@
+#include "corpus_generator.h"
+#include "corpus_loader.h"
+#include "process_queries.h"
+#include "search_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <execution>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct BenchmarkConfig {
+    CorpusConfig corpus;
+    int stop_word_count = 10;
+    int repeats = 5;
+    string format = "json"s;
+};
+
+struct BenchmarkResult {
+    string name;
+    size_t operations = 0;
+    int repeats = 0;
+    uint64_t best_ns = 0;
+    uint64_t median_ns = 0;
+    uint64_t checksum = 0;
+};
+
+// Runs body(prepare()) the given number of times, timing only the body
+template <typename Prepare, typename Body>
+BenchmarkResult Measure(const string& name, int repeats, size_t operations, Prepare prepare, Body body) {
+    vector<uint64_t> durations;
+    uint64_t checksum = 0;
+    for (int i = 0; i < repeats; ++i) {
+        auto state = prepare();
+        const auto start = chrono::steady_clock::now();
+        checksum = body(state);
+        const auto duration = chrono::steady_clock::now() - start;
+        durations.push_back(chrono::duration_cast<chrono::nanoseconds>(duration).count());
+    }
+    sort(durations.begin(), durations.end());
+    return { name, operations, repeats, durations.front(), durations[durations.size() / 2], checksum };
+}
+
+unique_ptr<SearchServer> BuildServer(const string& stop_words, const vector<GeneratedDocument>& documents) {
+    auto server = make_unique<SearchServer>(stop_words);
+    for (const auto& document : documents) {
+        server->AddDocument(document.id, document.text, document.status, document.ratings);
+    }
+    return server;
+}
+
+// Folds ids, ratings and relevances rounded to EPSILON, so a change in scoring shows up
+// even when the order of the results is kept
+uint64_t Checksum(const vector<Document>& documents) {
+    uint64_t checksum = documents.size();
+    for (const Document& document : documents) {
+        checksum = checksum * 31 + static_cast<uint64_t>(document.id);
+        checksum = checksum * 31 + static_cast<uint64_t>(document.rating);
+        checksum = checksum * 31 + static_cast<uint64_t>(llround(document.relevance / EPSILON));
+    }
+    return checksum;
+}
+
+template <typename ExecutionPolicy>
+uint64_t RunFindTopDocuments(ExecutionPolicy&& policy, const SearchServer& server, const vector<string>& queries) {
+    uint64_t checksum = 0;
+    for (const string& query : queries) {
+        checksum += Checksum(server.FindTopDocuments(policy, query));
+    }
+    return checksum;
+}
+
+bool ParseArgument(const string& argument, BenchmarkConfig& config) {
+    const auto separator = argument.find('=');
+    if (argument.rfind("--"s, 0) != 0 || separator == string::npos) {
+        return false;
+    }
+    const string key = argument.substr(2, separator - 2);
+    const string value = argument.substr(separator + 1);
+    if (key == "documents"s) {
+        config.corpus.document_count = stoi(value);
+        return config.corpus.document_count > 0;
+    }
+    else if (key == "vocabulary"s) {
+        config.corpus.vocabulary_size = stoi(value);
+        return config.corpus.vocabulary_size > 0;
+    }
+    else if (key == "document-words"s) {
+        config.corpus.words_per_document = stoi(value);
+    }
+    else if (key == "queries"s) {
+        config.corpus.query_count = stoi(value);
+    }
+    else if (key == "query-words"s) {
+        config.corpus.words_per_query = stoi(value);
+    }
+    else if (key == "zipf"s) {
+        config.corpus.zipf_exponent = stod(value);
+    }
+    else if (key == "minus-share"s) {
+        config.corpus.minus_word_share = stod(value);
+    }
+    else if (key == "duplicate-share"s) {
+        config.corpus.duplicate_share = stod(value);
+    }
+    else if (key == "seed"s) {
+        config.corpus.seed = static_cast<uint32_t>(stoul(value));
+    }
+    else if (key == "stop-words"s) {
+        config.stop_word_count = stoi(value);
+    }
+    else if (key == "repeats"s) {
+        config.repeats = max(1, stoi(value));
+    }
+    else if (key == "format"s && (value == "json"s || value == "csv"s)) {
+        config.format = value;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+void PrintJson(ostream& out, const BenchmarkConfig& config, const SearchServer::MemoryUsage& memory,
+    const vector<BenchmarkResult>& results) {
+    const CorpusConfig& corpus = config.corpus;
+    out << "{\n"s
+        << "  \"config\": { \"documents\": "s << corpus.document_count
+        << ", \"vocabulary\": "s << corpus.vocabulary_size
+        << ", \"document_words\": "s << corpus.words_per_document
+        << ", \"queries\": "s << corpus.query_count
+        << ", \"query_words\": "s << corpus.words_per_query
+        << ", \"zipf\": "s << corpus.zipf_exponent
+        << ", \"minus_share\": "s << corpus.minus_word_share
+        << ", \"duplicate_share\": "s << corpus.duplicate_share
+        << ", \"seed\": "s << corpus.seed
+        << ", \"repeats\": "s << config.repeats << " },\n"s
+        << "  \"memory\": { \"documents\": "s << memory.documents
+        << ", \"dictionary\": "s << memory.dictionary
+        << ", \"forward_index\": "s << memory.forward_index
+        << ", \"inverted_index\": "s << memory.inverted_index
+        << ", \"total\": "s << memory.GetTotal() << " },\n"s
+        << "  \"results\": [\n"s;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        out << "    { \"name\": \""s << result.name
+            << "\", \"operations\": "s << result.operations
+            << ", \"best_ns\": "s << result.best_ns
+            << ", \"median_ns\": "s << result.median_ns
+            << ", \"median_ns_per_op\": "s << result.median_ns / max<size_t>(result.operations, 1)
+            << ", \"checksum\": "s << result.checksum << " }"s
+            << (i + 1 < results.size() ? ",\n"s : "\n"s);
+    }
+    out << "  ]\n}\n"s;
+}
+
+void PrintCsv(ostream& out, const vector<BenchmarkResult>& results) {
+    out << "name,operations,repeats,best_ns,median_ns,median_ns_per_op,checksum\n"s;
+    for (const auto& result : results) {
+        out << result.name << ','
+            << result.operations << ','
+            << result.repeats << ','
+            << result.best_ns << ','
+            << result.median_ns << ','
+            << result.median_ns / max<size_t>(result.operations, 1) << ','
+            << result.checksum << '\n';
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config;
+    for (int i = 1; i < argc; ++i) {
+        if (!ParseArgument(argv[i], config)) {
+            cerr << "Invalid argument: "s << argv[i] << '\n'
+                << "Usage: "s << argv[0] << " [--documents=N] [--vocabulary=N] [--document-words=N]"s
+                << " [--queries=N] [--query-words=N] [--zipf=S] [--minus-share=P] [--duplicate-share=P]"s
+                << " [--seed=N] [--stop-words=N] [--repeats=N] [--format=json|csv]\n"s;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto vocabulary = GenerateVocabulary(config.corpus.vocabulary_size);
+    const string stop_words = GenerateStopWords(vocabulary, config.stop_word_count);
+    const auto documents = GenerateDocuments(config.corpus, vocabulary);
+    const auto queries = GenerateQueries(config.corpus, vocabulary);
+    const auto server = BuildServer(stop_words, documents);
+    const int repeats = config.repeats;
+    const auto no_state = [] { return 0; };
+
+    vector<BenchmarkResult> results;
+
+    results.push_back(Measure("AddDocument"s, repeats, documents.size(), no_state,
+        [&](int) {
+            return static_cast<uint64_t>(BuildServer(stop_words, documents)->GetDocumentCount());
+        }));
+
+    {
+        const string corpus_path = "search_benchmark_corpus.tsv"s;
+        {
+            ofstream corpus_file(corpus_path, ios::binary);
+            WriteDocumentRecords(corpus_file, documents);
+        }
+        results.push_back(Measure("LoadDocuments"s, repeats, documents.size(), no_state,
+            [&](int) {
+                SearchServer loaded_server(stop_words);
+                return static_cast<uint64_t>(LoadDocuments(loaded_server, corpus_path));
+            }));
+        remove(corpus_path.c_str());
+    }
+
+    results.push_back(Measure("FindTopDocuments/seq"s, repeats, queries.size(), no_state,
+        [&](int) {
+            return RunFindTopDocuments(execution::seq, *server, queries);
+        }));
+
+    results.push_back(Measure("FindTopDocuments/par"s, repeats, queries.size(), no_state,
+        [&](int) {
+            return RunFindTopDocuments(execution::par, *server, queries);
+        }));
+
+    results.push_back(Measure("FindTopDocumentsAllWords"s, repeats, queries.size(), no_state,
+        [&](int) {
+            uint64_t checksum = 0;
+            for (const string& query : queries) {
+                checksum += Checksum(server->FindTopDocumentsAllWords(query));
+            }
+            return checksum;
+        }));
+
+    results.push_back(Measure("ProcessQueries"s, repeats, queries.size(), no_state,
+        [&](int) {
+            uint64_t checksum = 0;
+            for (const auto& documents : ProcessQueries(*server, queries)) {
+                checksum += Checksum(documents);
+            }
+            return checksum;
+        }));
+
+    results.push_back(Measure("MatchDocument"s, repeats, queries.size(), no_state,
+        [&](int) {
+            uint64_t checksum = 0;
+            for (size_t i = 0; i < queries.size(); ++i) {
+                const int document_id = documents[i % documents.size()].id;
+                checksum += get<0>(server->MatchDocument(queries[i], document_id)).size();
+            }
+            return checksum;
+        }));
+
+    results.push_back(Measure("RemoveDocument"s, repeats, (documents.size() + 1) / 2,
+        [&] { return BuildServer(stop_words, documents); },
+        [&](unique_ptr<SearchServer>& fresh_server) {
+            for (size_t i = 0; i < documents.size(); i += 2) {
+                fresh_server->RemoveDocument(documents[i].id);
+            }
+            return static_cast<uint64_t>(fresh_server->GetDocumentCount());
+        }));
+
+    results.push_back(Measure("RemoveDuplicates"s, repeats, documents.size(),
+        [&] { return BuildServer(stop_words, documents); },
+        [&](unique_ptr<SearchServer>& fresh_server) {
+            // RemoveDuplicates reports every removal to cout, keep it out of the results
+            ostringstream sink;
+            auto* old_buffer = cout.rdbuf(sink.rdbuf());
+            RemoveDuplicates(*fresh_server);
+            cout.rdbuf(old_buffer);
+            return static_cast<uint64_t>(fresh_server->GetDocumentCount());
+        }));
+
+    if (config.format == "csv"s) {
+        PrintCsv(cout, results);
+    }
+    else {
+        PrintJson(cout, config, server->GetMemoryUsage(), results);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+#include "corpus_generator.h"
+
+#include <algorithm>
+#include <cmath>
+
+ZipfDistribution::ZipfDistribution(int vocabulary_size, double exponent)
+    : cumulative_(vocabulary_size)
+{
+    double sum = 0.0;
+    for (int rank = 0; rank < vocabulary_size; ++rank) {
+        sum += 1.0 / std::pow(rank + 1.0, exponent);
+        cumulative_[rank] = sum;
+    }
+    for (double& value : cumulative_) {
+        value /= sum;
+    }
+}
+
+int ZipfDistribution::operator()(std::mt19937& generator) const {
+    const double point = std::uniform_real_distribution<double>(0.0, 1.0)(generator);
+    const auto it = std::lower_bound(cumulative_.begin(), cumulative_.end(), point);
+    return std::min(static_cast<int>(it - cumulative_.begin()), static_cast<int>(cumulative_.size()) - 1);
+}
+
+std::vector<std::string> GenerateVocabulary(int vocabulary_size) {
+    std::vector<std::string> vocabulary;
+    vocabulary.reserve(vocabulary_size);
+    for (int i = 0; i < vocabulary_size; ++i) {
+        std::string word = "w";
+        int rest = i;
+        do {
+            word += static_cast<char>('a' + rest % 26);
+            rest /= 26;
+        } while (rest > 0);
+        vocabulary.push_back(std::move(word));
+    }
+    return vocabulary;
+}
+
+std::string GenerateStopWords(const std::vector<std::string>& vocabulary, int count) {
+    std::string stop_words;
+    for (int i = 0; i < count && i < static_cast<int>(vocabulary.size()); ++i) {
+        if (!stop_words.empty()) {
+            stop_words += ' ';
+        }
+        stop_words += vocabulary[i];
+    }
+    return stop_words;
+}
+
+namespace {
+DocumentStatus GenerateStatus(std::mt19937& generator) {
+    const int roll = std::uniform_int_distribution<int>(0, 99)(generator);
+    if (roll < 80) {
+        return DocumentStatus::ACTUAL;
+    }
+    if (roll < 90) {
+        return DocumentStatus::IRRELEVANT;
+    }
+    if (roll < 97) {
+        return DocumentStatus::BANNED;
+    }
+    return DocumentStatus::REMOVED;
+}
+}
+
+std::vector<GeneratedDocument> GenerateDocuments(const CorpusConfig& config, const std::vector<std::string>& vocabulary) {
+    std::mt19937 generator(config.seed);
+    const ZipfDistribution zipf(static_cast<int>(vocabulary.size()), config.zipf_exponent);
+    std::uniform_int_distribution<int> rating_count(1, 5);
+    std::uniform_int_distribution<int> rating_value(-10, 10);
+    std::uniform_real_distribution<double> share(0.0, 1.0);
+
+    std::vector<GeneratedDocument> documents;
+    documents.reserve(config.document_count);
+    for (int id = 0; id < config.document_count; ++id) {
+        GeneratedDocument document{ id, {}, GenerateStatus(generator), {} };
+        if (!documents.empty() && share(generator) < config.duplicate_share) {
+            const auto& original = documents[std::uniform_int_distribution<size_t>(0, documents.size() - 1)(generator)];
+            document.text = original.text;
+        }
+        else {
+            for (int i = 0; i < config.words_per_document; ++i) {
+                if (i > 0) {
+                    document.text += ' ';
+                }
+                document.text += vocabulary[zipf(generator)];
+            }
+        }
+        const int ratings = rating_count(generator);
+        for (int i = 0; i < ratings; ++i) {
+            document.ratings.push_back(rating_value(generator));
+        }
+        documents.push_back(std::move(document));
+    }
+    return documents;
+}
+
+void WriteDocumentRecords(std::ostream& out, const std::vector<GeneratedDocument>& documents) {
+    for (const GeneratedDocument& document : documents) {
+        out << document.id << '\t' << static_cast<int>(document.status) << '\t';
+        for (size_t i = 0; i < document.ratings.size(); ++i) {
+            out << (i > 0 ? " " : "") << document.ratings[i];
+        }
+        out << '\t' << document.text << '\n';
+    }
+}
+
+std::vector<std::string> GenerateQueries(const CorpusConfig& config, const std::vector<std::string>& vocabulary) {
+    // A separate stream keeps queries stable when only the document count changes
+    std::mt19937 generator(config.seed + 1);
+    const ZipfDistribution zipf(static_cast<int>(vocabulary.size()), config.zipf_exponent);
+    std::uniform_real_distribution<double> share(0.0, 1.0);
+
+    std::vector<std::string> queries;
+    queries.reserve(config.query_count);
+    for (int q = 0; q < config.query_count; ++q) {
+        std::string query;
+        for (int i = 0; i < config.words_per_query; ++i) {
+            if (i > 0) {
+                query += ' ';
+            }
+            if (share(generator) < config.minus_word_share) {
+                query += '-';
+            }
+            query += vocabulary[zipf(generator)];
+        }
+        queries.push_back(std::move(query));
+    }
+    return queries;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "document.h"
+
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+struct CorpusConfig {
+    int document_count = 10000;
+    int vocabulary_size = 10000;
+    int words_per_document = 50;
+    int query_count = 1000;
+    int words_per_query = 5;
+    double zipf_exponent = 1.0;
+    // Share of query words turned into minus words
+    double minus_word_share = 0.1;
+    // Share of documents repeated under another id, for RemoveDuplicates
+    double duplicate_share = 0.05;
+    uint32_t seed = 42;
+};
+
+struct GeneratedDocument {
+    int id;
+    std::string text;
+    DocumentStatus status;
+    std::vector<int> ratings;
+};
+
+// Draws word ranks from a Zipf distribution over [0, vocabulary_size)
+class ZipfDistribution {
+public:
+    ZipfDistribution(int vocabulary_size, double exponent);
+
+    int operator()(std::mt19937& generator) const;
+
+private:
+    std::vector<double> cumulative_;
+};
+
+std::vector<std::string> GenerateVocabulary(int vocabulary_size);
+
+std::string GenerateStopWords(const std::vector<std::string>& vocabulary, int count);
+
+std::vector<GeneratedDocument> GenerateDocuments(const CorpusConfig& config, const std::vector<std::string>& vocabulary);
+
+std::vector<std::string> GenerateQueries(const CorpusConfig& config, const std::vector<std::string>& vocabulary);
+
+// Writes documents in the dump format read by LoadDocuments (corpus_loader.h)
+void WriteDocumentRecords(std::ostream& out, const std::vector<GeneratedDocument>& documents);
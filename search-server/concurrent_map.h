@@ -4,6 +4,8 @@
 #include <map>
 #include <vector>
 
+#include "search_stats.h"
+
 using namespace std::string_literals;
 
 template <typename Key, typename Value>
@@ -16,6 +18,19 @@ private:
     };
     std::vector<Bucket> buckets_;
 
+    // Locks the mutex, counting contended acquisitions when stats are enabled
+    static std::mutex& LockBucket(std::mutex& mutex) {
+#ifdef SEARCH_SERVER_STATS
+        if (!mutex.try_lock()) {
+            SEARCH_STATS_COUNT(LOCK_WAITS, 1);
+            mutex.lock();
+        }
+#else
+        mutex.lock();
+#endif
+        return mutex;
+    }
+
 public:
     static_assert(std::is_integral_v<Key>, "ConcurrentMap supports only integer keys"s);
 
@@ -24,7 +39,7 @@ public:
         Value& ref_to_value;
 
         Access(const Key& key, Bucket& bucket)
-            : guard(bucket.mutex), ref_to_value(bucket.map[key]) {
+            : guard(LockBucket(bucket.mutex), std::adopt_lock), ref_to_value(bucket.map[key]) {
         }
     };
 
@@ -46,7 +61,7 @@ public:
     }
     auto Erase(const Key& key) {
         uint64_t tmp_key = static_cast<uint64_t>(key) % buckets_.size();
-        std::lock_guard guard(buckets_[tmp_key].mutex);
+        std::lock_guard guard(LockBucket(buckets_[tmp_key].mutex), std::adopt_lock);
         return buckets_[tmp_key].map.erase(key);
     }
 };
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include "corpus_loader.h"
+
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <execution>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#include <fstream>
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std::string_literals;
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("Cannot open "s + path);
+    }
+    std::ostringstream buffer;
+    buffer << input.rdbuf();
+    contents_ = buffer.str();
+    data_ = contents_.data();
+    size_ = contents_.size();
+}
+
+MappedFile::~MappedFile() = default;
+#else
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open "s + path);
+    }
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) < 0) {
+        close(fd);
+        throw std::runtime_error("Cannot stat "s + path);
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    if (size_ > 0) {
+        void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Cannot map "s + path);
+        }
+        madvise(mapping, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(mapping);
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+#endif
+
+std::string_view MappedFile::GetContents() const {
+    return { data_, size_ };
+}
+
+namespace {
+[[noreturn]] void ThrowMalformedRecord(size_t offset, const std::string& reason) {
+    throw std::invalid_argument("Malformed document record at byte "s + std::to_string(offset) + ": "s + reason);
+}
+
+std::string_view TakeField(std::string_view& line) {
+    const size_t tab = line.find('\t');
+    if (tab == std::string_view::npos) {
+        return {};
+    }
+    const std::string_view field = line.substr(0, tab);
+    line.remove_prefix(tab + 1);
+    return field;
+}
+
+bool ParseInt(std::string_view text, int& value) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+bool ParseStatus(std::string_view text, DocumentStatus& status) {
+    static const std::pair<std::string_view, DocumentStatus> names[] = {
+        { "ACTUAL", DocumentStatus::ACTUAL },
+        { "IRRELEVANT", DocumentStatus::IRRELEVANT },
+        { "BANNED", DocumentStatus::BANNED },
+        { "REMOVED", DocumentStatus::REMOVED },
+    };
+    for (const auto& [name, value] : names) {
+        if (text == name) {
+            status = value;
+            return true;
+        }
+    }
+    int number = 0;
+    if (ParseInt(text, number) && number >= 0 && static_cast<size_t>(number) < DOCUMENT_STATUS_COUNT) {
+        status = static_cast<DocumentStatus>(number);
+        return true;
+    }
+    return false;
+}
+
+DocumentRecord ParseRecord(std::string_view line, size_t offset) {
+    DocumentRecord record{ 0, DocumentStatus::ACTUAL, {}, {}, offset };
+    if (!ParseInt(TakeField(line), record.id)) {
+        ThrowMalformedRecord(offset, "invalid id"s);
+    }
+    if (!ParseStatus(TakeField(line), record.status)) {
+        ThrowMalformedRecord(offset, "invalid status"s);
+    }
+    const size_t tab = line.find('\t');
+    if (tab == std::string_view::npos) {
+        ThrowMalformedRecord(offset, "missing text field"s);
+    }
+    for (auto rating : SplitIntoWordsView(line.substr(0, tab))) {
+        int value = 0;
+        if (!ParseInt(rating, value)) {
+            ThrowMalformedRecord(offset, "invalid rating"s);
+        }
+        record.ratings.push_back(value);
+    }
+    record.text = line.substr(tab + 1);
+    return record;
+}
+
+void ParseChunk(std::string_view data, size_t first, size_t last, std::vector<DocumentRecord>& records) {
+    while (first < last) {
+        size_t line_end = data.find('\n', first);
+        if (line_end == std::string_view::npos) {
+            line_end = data.size();
+        }
+        std::string_view line = data.substr(first, line_end - first);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (!line.empty()) {
+            records.push_back(ParseRecord(line, first));
+        }
+        first = line_end + 1;
+    }
+}
+}
+
+std::vector<DocumentRecord> ParseDocumentRecords(std::string_view data) {
+    // Several chunks per thread even out records of different lengths
+    const size_t chunk_count = std::max<size_t>(1,
+        std::min<size_t>(std::thread::hardware_concurrency() * 4, data.size() / (64 * 1024) + 1));
+    std::vector<size_t> boundaries(chunk_count + 1, data.size());
+    boundaries[0] = 0;
+    for (size_t i = 1; i < chunk_count; ++i) {
+        const size_t line_end = data.find('\n', std::max(boundaries[i - 1], i * data.size() / chunk_count));
+        boundaries[i] = line_end == std::string_view::npos ? data.size() : line_end + 1;
+    }
+
+    std::vector<std::vector<DocumentRecord>> chunk_records(chunk_count);
+    std::vector<std::exception_ptr> chunk_errors(chunk_count);
+    std::vector<size_t> chunks(chunk_count);
+    std::iota(chunks.begin(), chunks.end(), 0);
+    std::for_each(std::execution::par, chunks.begin(), chunks.end(),
+        [data, &boundaries, &chunk_records, &chunk_errors](size_t chunk) {
+            // Exceptions must not escape a parallel algorithm, so they are rethrown below
+            try {
+                ParseChunk(data, boundaries[chunk], boundaries[chunk + 1], chunk_records[chunk]);
+            }
+            catch (...) {
+                chunk_errors[chunk] = std::current_exception();
+            }
+        });
+    for (const auto& error : chunk_errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::vector<DocumentRecord> records;
+    records.reserve(std::accumulate(chunk_records.begin(), chunk_records.end(), size_t(0),
+        [](size_t total, const std::vector<DocumentRecord>& chunk) {
+            return total + chunk.size();
+        }));
+    for (auto& chunk : chunk_records) {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(records));
+    }
+    return records;
+}
+
+size_t LoadDocuments(SearchServer& search_server, const std::string& path) {
+    const MappedFile file(path);
+    const auto records = ParseDocumentRecords(file.GetContents());
+    // The file is loaded completely or not at all
+    size_t loaded_count = 0;
+    const auto remove_loaded = [&search_server, &records, &loaded_count] {
+        for (size_t i = 0; i < loaded_count; ++i) {
+            search_server.RemoveDocument(records[i].id);
+        }
+    };
+    // AddDocument tokenizes the mapped text in place; only new words are copied, into the dictionary
+    for (const DocumentRecord& record : records) {
+        try {
+            search_server.AddDocument(record.id, record.text, record.status, record.ratings);
+        }
+        catch (const std::invalid_argument& error) {
+            remove_loaded();
+            ThrowMalformedRecord(record.offset, error.what());
+        }
+        catch (...) {
+            remove_loaded();
+            throw;
+        }
+        ++loaded_count;
+    }
+    return records.size();
+}
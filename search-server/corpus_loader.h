@@ -0,0 +1,51 @@
+#pragma once
+
+#include "document.h"
+#include "search_server.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Document dump format, one record per line, fields separated by tabs:
+//   <id>\t<status>\t<ratings separated by spaces>\t<text>\n
+// status is ACTUAL, IRRELEVANT, BANNED, REMOVED or its numeric value.
+
+struct DocumentRecord {
+    int id;
+    DocumentStatus status;
+    std::vector<int> ratings;
+    // Points into the parsed buffer, which must outlive the record
+    std::string_view text;
+    // Byte offset of the record in the parsed buffer, for error messages
+    size_t offset;
+};
+
+// Read-only view of a whole file, memory-mapped where the platform allows it
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view GetContents() const;
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    std::string contents_;
+#endif
+};
+
+// Splits data into chunks on line boundaries and parses them in parallel.
+// Throws std::invalid_argument naming the byte offset of the first malformed record
+std::vector<DocumentRecord> ParseDocumentRecords(std::string_view data);
+
+// Maps the file, parses it and adds every record to the server in file order.
+// If the server rejects a record, the documents added so far are removed again and
+// std::invalid_argument names the byte offset of the record.
+// Returns the number of documents added
+size_t LoadDocuments(SearchServer& search_server, const std::string& path);
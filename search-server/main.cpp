@@ -1,5 +1,6 @@
 #include "process_queries.h"
 #include "search_server.h"
+#include "test_exampe_functions.h"
 #include <execution>
 #include <iostream>
 #include <string>
@@ -14,6 +15,8 @@ void PrintDocument(const Document& document) {
         << "rating = "s << document.rating << " }"s << endl;
 }
 int main() {
+    TestSearchServer();
+
     SearchServer search_server("and with"s);
     int id = 0;
     for (
@@ -41,5 +44,8 @@ int main() {
     for (const Document& document : search_server.FindTopDocuments(execution::par, "curly nasty cat"s, [](int document_id, DocumentStatus status, int rating) { return document_id % 2 == 0; })) {
         PrintDocument(document);
     }
+#ifdef SEARCH_SERVER_STATS
+    SearchStats::Instance().Print(cout);
+#endif
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "posting_list.h"
+
+#include <algorithm>
+
+void PostingList::Insert(int document_id, int rating, double term_freq) {
+    const Posting posting{ document_id, rating, term_freq };
+    // Documents usually arrive in increasing id order, so appending is the common case
+    if (postings_.empty() || postings_.back().document_id < document_id) {
+        postings_.push_back(posting);
+        return;
+    }
+    const auto iter = LowerBound(document_id);
+    if (iter != postings_.end() && iter->document_id == document_id) {
+        *iter = posting;
+    }
+    else {
+        postings_.insert(iter, posting);
+    }
+}
+
+bool PostingList::Erase(int document_id) {
+    const auto iter = LowerBound(document_id);
+    if (iter == postings_.end() || iter->document_id != document_id) {
+        return false;
+    }
+    postings_.erase(iter);
+    return true;
+}
+
+bool PostingList::Contains(int document_id) const {
+    return std::binary_search(postings_.begin(), postings_.end(), Posting{ document_id, 0, 0.0 },
+        [](const Posting& lhs, const Posting& rhs) {
+            return lhs.document_id < rhs.document_id;
+        });
+}
+
+PostingList::const_iterator PostingList::Seek(const_iterator from, int document_id) const {
+    const auto last = postings_.end();
+    if (from == last || from->document_id >= document_id) {
+        return from;
+    }
+    // Invariant: low->document_id < document_id; widen the step until it overshoots
+    auto low = from;
+    auto high = last;
+    for (ptrdiff_t step = 1; last - low > step; step *= 2) {
+        const auto probe = low + step;
+        if (probe->document_id >= document_id) {
+            high = probe;
+            break;
+        }
+        low = probe;
+    }
+    return std::lower_bound(low + 1, high, document_id,
+        [](const Posting& posting, int id) {
+            return posting.document_id < id;
+        });
+}
+
+size_t PostingList::GetMemoryUsage() const {
+    return postings_.capacity() * sizeof(Posting);
+}
+
+std::vector<PostingList::Posting>::iterator PostingList::LowerBound(int document_id) {
+    return std::lower_bound(postings_.begin(), postings_.end(), document_id,
+        [](const Posting& posting, int id) {
+            return posting.document_id < id;
+        });
+}
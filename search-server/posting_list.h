@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Postings of a word, kept contiguous and sorted by document id
+class PostingList {
+public:
+    struct Posting {
+        int document_id;
+        // Takes the place of the padding after the id, so postings stay 16 bytes
+        int rating;
+        double term_freq;
+    };
+    using const_iterator = std::vector<Posting>::const_iterator;
+
+    void Insert(int document_id, int rating, double term_freq);
+    bool Erase(int document_id);
+    bool Contains(int document_id) const;
+
+    // First posting at or after from with id >= document_id, found by galloping
+    // forward from from, so a sequence of increasing seeks costs O(log gap) each
+    const_iterator Seek(const_iterator from, int document_id) const;
+
+    const_iterator begin() const {
+        return postings_.begin();
+    }
+
+    const_iterator end() const {
+        return postings_.end();
+    }
+
+    size_t size() const {
+        return postings_.size();
+    }
+
+    bool empty() const {
+        return postings_.empty();
+    }
+
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<Posting> postings_;
+
+    std::vector<Posting>::iterator LowerBound(int document_id);
+};
@@ -3,12 +3,9 @@
 std::vector<std::vector<Document>> ProcessQueries(
     const SearchServer& search_server,
     const std::vector<std::string>& queries) {
+    SEARCH_STATS_TIMER(PROCESS_QUERIES);
 
-    std::vector<std::vector<Document>> result(queries.size());
-    std::transform(std::execution::par, queries.begin(), queries.end(), result.begin(), [&search_server](auto& query)
-        {return search_server.FindTopDocuments(query); });
-    return result;
-
+    return search_server.FindTopDocumentsBatch(queries);
 }
 
 std::vector<Document> ProcessQueriesJoined(
@@ -12,6 +12,7 @@ SearchServer::SearchServer(std::string_view stop_words_text)
 
 void SearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status,
     const std::vector<int>& ratings) {
+    SEARCH_STATS_TIMER(ADD_DOCUMENT);
 
     if (document_id < 0) {
         throw std::invalid_argument("   id"s);
@@ -24,17 +25,50 @@ void SearchServer::AddDocument(int document_id, std::string_view document, Docum
     }
 
     auto words = SplitIntoWordsNoStop(document);
-    const std::string document_string{ document };
-    documents_.emplace(document_id, DocumentData{ SearchServer::ComputeAverageRating(ratings), status, document_string });
-
-    words = SplitIntoWordsNoStop(documents_.at(document_id).text_);
-
-    for (auto word : words) {
-        word_to_document_freqs_[word][document_id] += 1.0 / words.size();
-        document_to_word_freqs_[document_id][word] += 1.0 / words.size();
+    const int rating = ComputeAverageRating(ratings);
+    const size_t partition = static_cast<size_t>(status);
+
+    // Equal words become adjacent, so each run is one (word, term frequency) entry
+    std::sort(words.begin(), words.end());
+    std::vector<std::pair<std::string_view, double>> word_freqs;
+    for (auto begin = words.begin(); begin != words.end();) {
+        const auto end = std::find_if(begin, words.end(), [begin](std::string_view word) {
+            return word != *begin;
+        });
+        double term_freq = 0.0;
+        for (auto it = begin; it != end; ++it) {
+            term_freq += 1.0 / words.size();
+        }
+        word_freqs.emplace_back(*begin, term_freq);
+        begin = end;
+    }
+    word_freqs.shrink_to_fit();
+
+    // Everything is allocated before the document appears in documents_; if an
+    // allocation fails, the words indexed so far are taken back
+    size_t indexed_word_count = 0;
+    try {
+        for (auto& [word, term_freq] : word_freqs) {
+            word = *words_.emplace(word).first;
+            auto& postings = word_to_document_freqs_[word];
+            postings.by_status[partition].Insert(document_id, rating, term_freq);
+            ++postings.document_count;
+            ++indexed_word_count;
+        }
+        auto& document_word_freqs = document_to_word_freqs_[document_id];
+        document_ids_.emplace(document_id);
+        documents_.emplace(document_id, DocumentData{ rating, status });
+        document_word_freqs.swap(word_freqs);
+    }
+    catch (...) {
+        document_ids_.erase(document_id);
+        document_to_word_freqs_.erase(document_id);
+        // The word being indexed when the failure happened may be partly added too
+        for (size_t i = 0; i < word_freqs.size() && i <= indexed_word_count; ++i) {
+            RemoveWordPosting(word_freqs[i].first, partition, document_id);
+        }
+        throw;
     }
-
-    document_ids_.emplace(document_id);
 }
 
 std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status) const {
@@ -45,9 +79,136 @@ std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query)
     return FindTopDocuments(std::execution::seq, raw_query, DocumentStatus::ACTUAL);
 }
 
+std::vector<Document> SearchServer::FindTopDocumentsAllWords(std::string_view raw_query, DocumentStatus status) const {
+    return FindTopDocumentsAllWords(raw_query, StatusFilter{ status });
+}
+
+std::vector<Document> SearchServer::FindTopDocumentsAllWords(std::string_view raw_query) const {
+    return FindTopDocumentsAllWords(raw_query, DocumentStatus::ACTUAL);
+}
+
+std::vector<std::vector<Document>> SearchServer::FindTopDocumentsBatch(const std::vector<std::string>& raw_queries,
+    DocumentStatus status) const {
+    std::vector<Query> queries;
+    queries.reserve(raw_queries.size());
+    for (const std::string& raw_query : raw_queries) {
+        queries.push_back(ParseQuery(raw_query));
+    }
+
+    // Shards trade posting sharing for parallelism: each one walks every distinct word of its queries once.
+    // A shard keeps every contribution of its queries until it is done, so its size is capped
+    const size_t shard_count = std::max<size_t>(1, std::min<size_t>(queries.size(),
+        std::max<size_t>(std::thread::hardware_concurrency(), (queries.size() + MAX_BATCH_SHARD_SIZE - 1) / MAX_BATCH_SHARD_SIZE)));
+    std::vector<size_t> shards(shard_count);
+    std::iota(shards.begin(), shards.end(), 0);
+
+    std::vector<std::vector<Document>> results(queries.size());
+    std::for_each(std::execution::par, shards.begin(), shards.end(),
+        [this, &queries, &results, status, shard_count](size_t shard) {
+            FindTopDocumentsShard(queries, shard * queries.size() / shard_count,
+                (shard + 1) * queries.size() / shard_count, status, results);
+        });
+    return results;
+}
+
+std::vector<std::vector<Document>> SearchServer::FindTopDocumentsBatch(const std::vector<std::string>& raw_queries) const {
+    return FindTopDocumentsBatch(raw_queries, DocumentStatus::ACTUAL);
+}
+
+void SearchServer::FindTopDocumentsShard(const std::vector<Query>& queries, size_t first, size_t last,
+    DocumentStatus status, std::vector<std::vector<Document>>& results) const {
+    // Words are visited in sorted order, the same order ParseQuery leaves them in,
+    // so every relevance is summed exactly as FindTopDocuments sums it
+    std::map<std::string_view, std::vector<size_t>> plus_word_to_queries;
+    std::map<std::string_view, std::vector<size_t>> minus_word_to_queries;
+    for (size_t i = first; i < last; ++i) {
+        for (auto word : queries[i].plus_words) {
+            plus_word_to_queries[word].push_back(i - first);
+        }
+        for (auto word : queries[i].minus_words) {
+            minus_word_to_queries[word].push_back(i - first);
+        }
+    }
+
+    const size_t partition = static_cast<size_t>(status);
+    struct Contribution {
+        int document_id;
+        int rating;
+        double relevance;
+    };
+    // Appending is much cheaper than scattering into per-query maps; contributions
+    // are summed per document after a stable sort, which keeps the word order
+    std::vector<std::vector<Contribution>> contributions(last - first);
+    std::vector<std::vector<int>> excluded_documents(last - first);
+
+    {
+        SEARCH_STATS_TIMER(POSTING_WALK);
+        size_t postings_scanned = 0;
+        for (const auto& [word, query_indexes] : plus_word_to_queries) {
+            const auto word_iter = word_to_document_freqs_.find(word);
+            if (word_iter == word_to_document_freqs_.end()) {
+                continue;
+            }
+            const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
+            for (const auto& [document_id, rating, term_freq] : word_iter->second.by_status[partition]) {
+                ++postings_scanned;
+                const Contribution contribution{ document_id, rating, term_freq * inverse_document_freq };
+                for (const size_t query_index : query_indexes) {
+                    contributions[query_index].push_back(contribution);
+                }
+            }
+        }
+        SEARCH_STATS_COUNT(POSTINGS_SCANNED, postings_scanned);
+    }
 
-std::map<std::string_view, double> SearchServer::GetWordFrequencies(const int& document_id) const {
-    return document_to_word_freqs_.at(document_id);
+    {
+        SEARCH_STATS_TIMER(MINUS_FILTER);
+        for (const auto& [word, query_indexes] : minus_word_to_queries) {
+            const auto word_iter = word_to_document_freqs_.find(word);
+            if (word_iter == word_to_document_freqs_.end()) {
+                continue;
+            }
+            for (const auto& posting : word_iter->second.by_status[partition]) {
+                for (const size_t query_index : query_indexes) {
+                    excluded_documents[query_index].push_back(posting.document_id);
+                }
+            }
+        }
+    }
+
+    SEARCH_STATS_TIMER(BUILD_RESULT);
+    for (size_t i = first; i < last; ++i) {
+        auto& query_contributions = contributions[i - first];
+        auto& query_excluded = excluded_documents[i - first];
+        std::stable_sort(query_contributions.begin(), query_contributions.end(),
+            [](const Contribution& lhs, const Contribution& rhs) {
+                return lhs.document_id < rhs.document_id;
+            });
+        std::sort(query_excluded.begin(), query_excluded.end());
+
+        std::vector<Document> matched_documents;
+        for (auto begin = query_contributions.begin(); begin != query_contributions.end();) {
+            const int document_id = begin->document_id;
+            double relevance = 0.0;
+            auto end = begin;
+            for (; end != query_contributions.end() && end->document_id == document_id; ++end) {
+                relevance += end->relevance;
+            }
+            if (!std::binary_search(query_excluded.begin(), query_excluded.end(), document_id)) {
+                matched_documents.push_back({ document_id, relevance, begin->rating });
+            }
+            begin = end;
+        }
+        SEARCH_STATS_COUNT(CANDIDATES, matched_documents.size());
+        SelectTopDocuments(std::execution::seq, matched_documents);
+        results[i] = std::move(matched_documents);
+    }
+}
+
+
+SearchServer::WordFrequencies SearchServer::GetWordFrequencies(const int& document_id) const {
+    const auto& word_freqs = document_to_word_freqs_.at(document_id);
+    return { word_freqs.begin(), word_freqs.end() };
 }
 
 SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text) const {
@@ -68,6 +229,7 @@ SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text) cons
 }
 
 SearchServer::Query SearchServer::ParseQuery(std::string_view text) const {
+    SEARCH_STATS_TIMER(PARSE_QUERY);
     Query result;
 
     for (auto word : SplitIntoWordsView(text)) {
@@ -116,40 +278,65 @@ SearchServer::Query SearchServer::ParseQueryParallel(std::string_view text) cons
 
 std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(std::string_view raw_query,
     int document_id) const {
+    SEARCH_STATS_TIMER(MATCH_DOCUMENT);
     const auto query = ParseQuery(raw_query);
+    const DocumentStatus status = documents_.at(document_id).status;
+    const size_t partition = static_cast<size_t>(status);
 
     std::vector<std::string_view> matched_words;
     for (auto word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
+        const auto word_iter = word_to_document_freqs_.find(word);
+        if (word_iter == word_to_document_freqs_.end()) {
             continue;
         }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
+        if (word_iter->second.by_status[partition].Contains(document_id)) {
             matched_words.push_back(word);
         }
     }
     for (auto word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
+        const auto word_iter = word_to_document_freqs_.find(word);
+        if (word_iter == word_to_document_freqs_.end()) {
             continue;
         }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
+        if (word_iter->second.by_status[partition].Contains(document_id)) {
             matched_words.clear();
             break;
         }
     }
-    return { matched_words, documents_.at(document_id).status };
+    return { matched_words, status };
 }
 
 void SearchServer::RemoveDocument(int document_id) {
-    documents_.erase(document_id);
-    document_ids_.erase(document_id);
-
     auto iter = document_to_word_freqs_.find(document_id);
+    if (iter == document_to_word_freqs_.end()) {
+        return;
+    }
+    const size_t partition = static_cast<size_t>(documents_.at(document_id).status);
 
     for (auto& it : (*iter).second) {
-        word_to_document_freqs_.at(it.first).erase(document_id);
+        RemoveWordPosting(it.first, partition, document_id);
     }
 
     this->document_to_word_freqs_.erase(iter);
+    documents_.erase(document_id);
+    document_ids_.erase(document_id);
+}
+
+void SearchServer::SetDocumentStatus(int document_id, DocumentStatus status) {
+    auto& document_data = documents_.at(document_id);
+    const size_t old_partition = static_cast<size_t>(document_data.status);
+    const size_t new_partition = static_cast<size_t>(status);
+    if (old_partition == new_partition) {
+        return;
+    }
+
+    for (const auto& [word, term_freq] : document_to_word_freqs_.at(document_id)) {
+        auto& by_status = word_to_document_freqs_.at(word).by_status;
+        by_status[old_partition].Erase(document_id);
+        by_status[new_partition].Insert(document_id, document_data.rating, term_freq);
+    }
+
+    document_data.status = status;
 }
 
 std::set<int>::iterator SearchServer::begin() const {
@@ -163,6 +350,46 @@ std::set<int>::iterator SearchServer::end() const {
 int SearchServer::GetDocumentCount() const {
     return int(documents_.size());
 }
+
+namespace {
+// Red-black tree node header of std::map and std::set: color and three links
+const size_t TREE_NODE_OVERHEAD = 4 * sizeof(void*);
+
+size_t GetHeapSize(const std::string& text) {
+    return text.capacity() > std::string().capacity() ? text.capacity() + 1 : 0;
+}
+}
+
+size_t SearchServer::MemoryUsage::GetTotal() const {
+    return documents + dictionary + forward_index + inverted_index;
+}
+
+SearchServer::MemoryUsage SearchServer::GetMemoryUsage() const {
+    MemoryUsage usage;
+
+    usage.documents = documents_.size() * (TREE_NODE_OVERHEAD + sizeof(std::pair<const int, DocumentData>))
+        + document_ids_.size() * (TREE_NODE_OVERHEAD + sizeof(int));
+
+    for (const auto& words : { std::cref(words_), std::cref(stop_words_) }) {
+        for (const std::string& word : words.get()) {
+            usage.dictionary += TREE_NODE_OVERHEAD + sizeof(std::string) + GetHeapSize(word);
+        }
+    }
+
+    for (const auto& [document_id, word_freqs] : document_to_word_freqs_) {
+        usage.forward_index += TREE_NODE_OVERHEAD + sizeof(std::pair<const int, std::vector<std::pair<std::string_view, double>>>)
+            + word_freqs.capacity() * sizeof(std::pair<std::string_view, double>);
+    }
+
+    for (const auto& [word, postings] : word_to_document_freqs_) {
+        usage.inverted_index += TREE_NODE_OVERHEAD + sizeof(std::pair<const std::string_view, WordPostings>);
+        for (const PostingList& posting_list : postings.by_status) {
+            usage.inverted_index += posting_list.GetMemoryUsage();
+        }
+    }
+
+    return usage;
+}
 bool SearchServer::IsStopWord(std::string_view word) const {
     return stop_words_.count(word) > 0;
 }
@@ -195,8 +422,26 @@ int SearchServer::ComputeAverageRating(const std::vector<int>& ratings) {
     return rating_sum / static_cast<int>(ratings.size());
 }
 
+void SearchServer::RemoveWordPosting(std::string_view word, size_t partition, int document_id) {
+    const auto word_iter = word_to_document_freqs_.find(word);
+    if (word_iter != word_to_document_freqs_.end()) {
+        if (word_iter->second.by_status[partition].Erase(document_id)) {
+            --word_iter->second.document_count;
+        }
+        if (word_iter->second.document_count > 0) {
+            return;
+        }
+        word_to_document_freqs_.erase(word_iter);
+    }
+    // The index keys view the dictionary string, so it goes last
+    const auto dictionary_iter = words_.find(word);
+    if (dictionary_iter != words_.end()) {
+        words_.erase(dictionary_iter);
+    }
+}
+
 double SearchServer::ComputeWordInverseDocumentFreq(std::string_view word) const {
-    return std::log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).size());
+    return std::log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).document_count);
 }
 
 void RemoveDuplicates(SearchServer& search_server) {
@@ -3,6 +3,9 @@
 #include "string_processing.h"
 #include "document.h"
 #include "concurrent_map.h"
+#include "search_stats.h"
+#include "posting_list.h"
+#include "paginator.h"
 
 #include <iostream>
 #include <string>
@@ -12,12 +15,42 @@
 #include <stdexcept>
 #include <cmath>
 #include <execution>
+#include <array>
+#include <utility>
+#include <type_traits>
+#include <functional>
+#include <numeric>
+#include <thread>
 
 const int MAX_RESULT_DOCUMENT_COUNT = 5;
+// Queries whose partial results a FindTopDocumentsBatch shard holds at once
+const size_t MAX_BATCH_SHARD_SIZE = 256;
 const double EPSILON = 1e-6;
 
 class SearchServer {
 public:
+    // Predicate type for status-only filters, answered by walking a single status partition
+    struct StatusFilter {
+        DocumentStatus status;
+
+        bool operator()(int document_id, DocumentStatus document_status, int rating) const {
+            return document_status == status;
+        }
+    };
+
+    // Non-owning view of the (word, term frequency) pairs of a document, sorted by word
+    using WordFrequencies = IteratorRange<std::vector<std::pair<std::string_view, double>>::const_iterator>;
+
+    // Approximate heap and node footprint of the index, in bytes
+    struct MemoryUsage {
+        size_t documents = 0;
+        size_t dictionary = 0;
+        size_t forward_index = 0;
+        size_t inverted_index = 0;
+
+        size_t GetTotal() const;
+    };
+
     template <typename StringContainer>
     explicit SearchServer(const StringContainer& stop_words);
 
@@ -28,6 +61,8 @@ public:
 
     void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
 
+    // document_predicate is called as (document_id, status, rating), or as (document_id)
+    // if it accepts only the id, in which case document metadata is not read at all
     template <typename ExecutionPolicy, typename DocumentPredicate>
     std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentPredicate document_predicate) const;
 
@@ -42,26 +77,55 @@ public:
     std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query) const;
     std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
 
+    // Conjunctive search: only documents containing every plus word are returned.
+    // Posting lists are intersected starting from the rarest word, so the work
+    // follows the shortest list rather than the sum of all of them
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocumentsAllWords(std::string_view raw_query, DocumentPredicate document_predicate) const;
+    std::vector<Document> FindTopDocumentsAllWords(std::string_view raw_query, DocumentStatus status) const;
+    std::vector<Document> FindTopDocumentsAllWords(std::string_view raw_query) const;
+
+    // Answers a batch of queries at once, walking the postings of each distinct word
+    // once per shard of at most MAX_BATCH_SHARD_SIZE queries. Results match
+    // FindTopDocuments for every query
+    std::vector<std::vector<Document>> FindTopDocumentsBatch(const std::vector<std::string>& raw_queries, DocumentStatus status) const;
+    std::vector<std::vector<Document>> FindTopDocumentsBatch(const std::vector<std::string>& raw_queries) const;
+
     std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id) const;
 
-    std::map<std::string_view, double> GetWordFrequencies(const int& document_id) const;
+    WordFrequencies GetWordFrequencies(const int& document_id) const;
 
     void RemoveDocument(int document_id);
 
+    // Moves the document to another status without reindexing its text
+    void SetDocumentStatus(int document_id, DocumentStatus status);
+
     std::set<int>::iterator begin() const;
     std::set<int>::iterator end() const;
 
     int GetDocumentCount() const;
 
+    MemoryUsage GetMemoryUsage() const;
+
 private:
     struct DocumentData {
         int rating;
         DocumentStatus status;
-        std::string text_;
     };
 
-    std::map<int, std::map<std::string_view, double>> document_to_word_freqs_;
-    std::map<std::string_view, std::map<int, double>> word_to_document_freqs_;
+    // Owns the words of the indexed documents, so the index views stay valid after
+    // documents are removed; a word is dropped together with its last posting
+    std::set<std::string, std::less<>> words_;
+    // Postings of a word, partitioned by the status of the document; the partition
+    // holding a posting gives the status, the posting itself carries the rating
+    struct WordPostings {
+        std::array<PostingList, DOCUMENT_STATUS_COUNT> by_status;
+        size_t document_count = 0;
+    };
+
+    // Forward index: packed (word, term frequency) pairs of each document, sorted by word
+    std::map<int, std::vector<std::pair<std::string_view, double>>> document_to_word_freqs_;
+    std::map<std::string_view, WordPostings> word_to_document_freqs_;
     const std::set<std::string, std::less<>> stop_words_;
     std::map<int, DocumentData> documents_;
     std::set<int> document_ids_;
@@ -74,6 +138,9 @@ private:
 
     static int ComputeAverageRating(const std::vector<int>& ratings);
 
+    // Drops the posting of the document from the word, and the word itself once no document has it
+    void RemoveWordPosting(std::string_view word, size_t partition, int document_id);
+
     struct QueryWord {
         std::string_view data;
         bool is_minus;
@@ -90,6 +157,11 @@ private:
     Query ParseQuery(std::string_view text) const;
     Query ParseQueryParallel(std::string_view text) const;
 
+    struct DocumentRelevance {
+        double relevance = 0.0;
+        int rating = 0;
+    };
+
    
 
     template<typename DocumentPredicate>
@@ -101,7 +173,25 @@ private:
     template<typename DocumentPredicate>
     std::vector<Document> FindAllDocuments(const std::execution::parallel_policy& policy, std::string_view raw_query, DocumentPredicate document_predicate) const;
 
+    template<typename DocumentPredicate>
+    std::vector<Document> FindAllDocumentsAllWords(std::string_view raw_query, DocumentPredicate document_predicate) const;
+
     double ComputeWordInverseDocumentFreq(std::string_view word) const;
+
+    // Sorts by relevance and rating and keeps the best MAX_RESULT_DOCUMENT_COUNT documents
+    template <typename ExecutionPolicy>
+    static void SelectTopDocuments(ExecutionPolicy&& policy, std::vector<Document>& matched_documents);
+
+    void FindTopDocumentsShard(const std::vector<Query>& queries, size_t first, size_t last, DocumentStatus status,
+        std::vector<std::vector<Document>>& results) const;
+
+    // Range of status partitions that can satisfy the predicate
+    template <typename DocumentPredicate>
+    static std::pair<size_t, size_t> GetStatusPartitions(const DocumentPredicate& document_predicate);
+
+    // The predicate is taken by non-const reference, so mutable predicates keep working
+    template <typename DocumentPredicate>
+    static bool IsDocumentAccepted(DocumentPredicate& document_predicate, const PostingList::Posting& posting, DocumentStatus status);
 };
 
 
@@ -117,24 +207,33 @@ SearchServer::SearchServer(const StringContainer& stop_words)
 template <typename ExecutionPolicy, typename DocumentPredicate>
 std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, 
     DocumentPredicate document_predicate) const {
+    SEARCH_STATS_TIMER(FIND_TOP_DOCUMENTS);
 
     std::vector<Document> matched_documents = FindAllDocuments(policy, raw_query, document_predicate);
+    SelectTopDocuments(policy, matched_documents);
+    return matched_documents;
+}
 
-    std::sort(policy, 
-        matched_documents.begin(), matched_documents.end(),
-        [](const Document& lhs, const Document& rhs) {
-            if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
-                return lhs.rating > rhs.rating;
-            }
-            else {
-                return lhs.relevance > rhs.relevance;
-            }
-        });
+template <typename ExecutionPolicy>
+void SearchServer::SelectTopDocuments(ExecutionPolicy&& policy, std::vector<Document>& matched_documents) {
+    {
+        SEARCH_STATS_TIMER(SORT);
+        std::sort(policy, 
+            matched_documents.begin(), matched_documents.end(),
+            [](const Document& lhs, const Document& rhs) {
+                if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
+                    return lhs.rating > rhs.rating;
+                }
+                else {
+                    return lhs.relevance > rhs.relevance;
+                }
+            });
+    }
     if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
         matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
     }
-
-    return matched_documents;
+    // Batches keep every result until they return, so the candidate buffer is given back
+    matched_documents.shrink_to_fit();
 }
 
 template <typename DocumentPredicate>
@@ -144,10 +243,7 @@ std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query,
 
 template <typename ExecutionPolicy>
 std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status) const {
-    return FindTopDocuments(policy, raw_query,
-        [&status](int document_id, DocumentStatus new_status, int rating) {
-            return new_status == status;
-        });
+    return FindTopDocuments(policy, raw_query, StatusFilter{ status });
 }
 
 template <typename ExecutionPolicy>
@@ -158,108 +254,275 @@ std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, s
 template <typename DocumentPredicate>
 std::vector<Document> SearchServer::FindAllDocuments(std::string_view raw_query,
     DocumentPredicate document_predicate) const {
+    return FindAllDocuments(std::execution::seq, raw_query, document_predicate);
+}
+template<typename DocumentPredicate>
+std::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy& policy, std::string_view raw_query, DocumentPredicate document_predicate) const {
+    std::map<int, DocumentRelevance> document_to_relevance;
     const auto query = ParseQuery(raw_query);
-    std::map<int, double> document_to_relevance;
-    for (auto word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-        for (const auto [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-            const auto& document_data = documents_.at(document_id);
-            if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                document_to_relevance[document_id] += term_freq * inverse_document_freq;
+    const auto [first_status, last_status] = GetStatusPartitions(document_predicate);
+
+    {
+        SEARCH_STATS_TIMER(POSTING_WALK);
+        size_t postings_scanned = 0;
+        size_t predicate_rejections = 0;
+        for (auto word : query.plus_words) {
+            const auto word_iter = word_to_document_freqs_.find(word);
+            if (word_iter == word_to_document_freqs_.end()) {
+                continue;
+            }
+            const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
+            for (size_t status = first_status; status < last_status; ++status) {
+                for (const auto& posting : word_iter->second.by_status[status]) {
+                    ++postings_scanned;
+                    if (IsDocumentAccepted(document_predicate, posting, static_cast<DocumentStatus>(status))) {
+                        auto& document_relevance = document_to_relevance[posting.document_id];
+                        document_relevance.relevance += posting.term_freq * inverse_document_freq;
+                        document_relevance.rating = posting.rating;
+                    }
+                    else {
+                        ++predicate_rejections;
+                    }
+                }
             }
         }
+        SEARCH_STATS_COUNT(POSTINGS_SCANNED, postings_scanned);
+        SEARCH_STATS_COUNT(PREDICATE_REJECTIONS, predicate_rejections);
     }
 
-    for (auto word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        for (const auto [document_id, _] : word_to_document_freqs_.at(word)) {
-            document_to_relevance.erase(document_id);
+    {
+        SEARCH_STATS_TIMER(MINUS_FILTER);
+        for (auto word : query.minus_words) {
+            const auto word_iter = word_to_document_freqs_.find(word);
+            if (word_iter == word_to_document_freqs_.end()) {
+                continue;
+            }
+            for (size_t status = first_status; status < last_status; ++status) {
+                for (const auto& posting : word_iter->second.by_status[status]) {
+                    document_to_relevance.erase(posting.document_id);
+                }
+            }
         }
     }
 
+    SEARCH_STATS_TIMER(BUILD_RESULT);
+    SEARCH_STATS_COUNT(CANDIDATES, document_to_relevance.size());
     std::vector<Document> matched_documents;
-    for (const auto [document_id, relevance] : document_to_relevance) {
-        matched_documents.push_back(
-            { document_id, relevance, documents_.at(document_id).rating });
+    for (const auto& [document_id, document_relevance] : document_to_relevance) {
+        matched_documents.push_back({ document_id, document_relevance.relevance, document_relevance.rating });
     }
     return matched_documents;
 }
+
 template<typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy& policy, std::string_view raw_query, DocumentPredicate document_predicate) const {
-    std::map<int, double> document_to_relevance;
+std::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy& policy, std::string_view raw_query, DocumentPredicate document_predicate) const {
+    ConcurrentMap<int, DocumentRelevance> document_to_relevance(16);
     const auto query = ParseQuery(raw_query);
-
-    for (auto word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-        for (const auto [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-            const auto& document_data = documents_.at(document_id);
-            if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                document_to_relevance[document_id] += term_freq * inverse_document_freq;
-            }
-        }
+    const auto [first_status, last_status] = GetStatusPartitions(document_predicate);
+
+    {
+        SEARCH_STATS_TIMER(POSTING_WALK);
+        std::for_each(policy,
+            query.plus_words.begin(), query.plus_words.end(),
+            [this, &document_predicate, &document_to_relevance, first_status = first_status, last_status = last_status](std::string_view word) {
+                const auto word_iter = word_to_document_freqs_.find(word);
+                if (word_iter != word_to_document_freqs_.end()) {
+                    const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
+                    size_t postings_scanned = 0;
+                    size_t predicate_rejections = 0;
+                    for (size_t status = first_status; status < last_status; ++status) {
+                        for (const auto& posting : word_iter->second.by_status[status]) {
+                            ++postings_scanned;
+                            if (IsDocumentAccepted(document_predicate, posting, static_cast<DocumentStatus>(status))) {
+                                auto access = document_to_relevance[posting.document_id];
+                                access.ref_to_value.relevance += posting.term_freq * inverse_document_freq;
+                                access.ref_to_value.rating = posting.rating;
+                            }
+                            else {
+                                ++predicate_rejections;
+                            }
+                        }
+                    }
+                    SEARCH_STATS_COUNT(POSTINGS_SCANNED, postings_scanned);
+                    SEARCH_STATS_COUNT(PREDICATE_REJECTIONS, predicate_rejections);
+                }
+            });
     }
 
-    for (auto word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        for (const auto [document_id, _] : word_to_document_freqs_.at(word)) {
-            document_to_relevance.erase(document_id);
-        }
+    {
+        SEARCH_STATS_TIMER(MINUS_FILTER);
+        std::for_each(policy,
+            query.minus_words.begin(), query.minus_words.end(),
+            [this, &document_to_relevance, first_status = first_status, last_status = last_status](std::string_view word) {
+                const auto word_iter = word_to_document_freqs_.find(word);
+                if (word_iter != word_to_document_freqs_.end()) {
+                    for (size_t status = first_status; status < last_status; ++status) {
+                        for (const auto& posting : word_iter->second.by_status[status]) {
+                            document_to_relevance.Erase(posting.document_id);
+                        }
+                    }
+                }
+            });
     }
 
+    SEARCH_STATS_TIMER(BUILD_RESULT);
+    std::map<int, DocumentRelevance> document_to_relevance_reduced = document_to_relevance.BuildOrdinaryMap();
+    SEARCH_STATS_COUNT(CANDIDATES, document_to_relevance_reduced.size());
     std::vector<Document> matched_documents;
-    for (const auto [document_id, relevance] : document_to_relevance) {
-        matched_documents.push_back({ document_id, relevance, documents_.at(document_id).rating });
+    matched_documents.reserve(document_to_relevance_reduced.size());
+
+    for (const auto& [document_id, document_relevance] : document_to_relevance_reduced) {
+        matched_documents.push_back({ document_id, document_relevance.relevance, document_relevance.rating });
     }
     return matched_documents;
 }
 
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocumentsAllWords(std::string_view raw_query, DocumentPredicate document_predicate) const {
+    SEARCH_STATS_TIMER(FIND_TOP_DOCUMENTS);
+    std::vector<Document> matched_documents = FindAllDocumentsAllWords(raw_query, document_predicate);
+    SelectTopDocuments(std::execution::seq, matched_documents);
+    return matched_documents;
+}
+
 template<typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy& policy, std::string_view raw_query, DocumentPredicate document_predicate) const {
-    ConcurrentMap<int, double> document_to_relevance(16);
+std::vector<Document> SearchServer::FindAllDocumentsAllWords(std::string_view raw_query, DocumentPredicate document_predicate) const {
     const auto query = ParseQuery(raw_query);
+    std::vector<Document> matched_documents;
+    if (query.plus_words.empty()) {
+        return matched_documents;
+    }
+
+    std::vector<const WordPostings*> plus_postings;
+    std::vector<double> inverse_document_freqs;
+    for (auto word : query.plus_words) {
+        const auto word_iter = word_to_document_freqs_.find(word);
+        if (word_iter == word_to_document_freqs_.end()) {
+            return matched_documents;
+        }
+        plus_postings.push_back(&word_iter->second);
+        inverse_document_freqs.push_back(ComputeWordInverseDocumentFreq(word));
+    }
+    std::vector<const WordPostings*> minus_postings;
+    for (auto word : query.minus_words) {
+        const auto word_iter = word_to_document_freqs_.find(word);
+        if (word_iter != word_to_document_freqs_.end()) {
+            minus_postings.push_back(&word_iter->second);
+        }
+    }
 
-    std::for_each(policy,
-        query.minus_words.begin(), query.minus_words.end(),
-        [this, &document_to_relevance](std::string_view word) {
-            if (word_to_document_freqs_.count(word)) {
-                for (const auto [document_id, _] : word_to_document_freqs_.at(word)) {
-                    document_to_relevance.Erase(document_id);
+    SEARCH_STATS_TIMER(POSTING_WALK);
+    size_t postings_scanned = 0;
+    size_t predicate_rejections = 0;
+    // A document lives in exactly one status partition, so partitions are intersected separately
+    const auto [first_status, last_status] = GetStatusPartitions(document_predicate);
+    for (size_t status = first_status; status < last_status; ++status) {
+        // Word positions ordered from the rarest word; relevance is still summed in query order
+        std::vector<size_t> order(plus_postings.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&plus_postings, status](size_t lhs, size_t rhs) {
+            return plus_postings[lhs]->by_status[status].size() < plus_postings[rhs]->by_status[status].size();
+        });
+        const PostingList& driver = plus_postings[order.front()]->by_status[status];
+        if (driver.empty()) {
+            continue;
+        }
+
+        std::vector<PostingList::const_iterator> cursors;
+        for (const WordPostings* postings : plus_postings) {
+            cursors.push_back(postings->by_status[status].begin());
+        }
+        std::vector<PostingList::const_iterator> minus_cursors;
+        for (const WordPostings* postings : minus_postings) {
+            minus_cursors.push_back(postings->by_status[status].begin());
+        }
+
+        auto& driver_cursor = cursors[order.front()];
+        while (driver_cursor != driver.end()) {
+            const int document_id = driver_cursor->document_id;
+            ++postings_scanned;
+
+            // Leapfrog: the first list that skips past document_id gives the next candidate
+            int next_candidate = document_id;
+            bool is_exhausted = false;
+            for (size_t k = 1; k < order.size() && next_candidate == document_id; ++k) {
+                const PostingList& postings = plus_postings[order[k]]->by_status[status];
+                auto& cursor = cursors[order[k]];
+                cursor = postings.Seek(cursor, document_id);
+                ++postings_scanned;
+                if (cursor == postings.end()) {
+                    is_exhausted = true;
+                    break;
                 }
+                next_candidate = cursor->document_id;
+            }
+            if (is_exhausted) {
+                break;
+            }
+            if (next_candidate != document_id) {
+                driver_cursor = driver.Seek(driver_cursor, next_candidate);
+                continue;
             }
-        });
 
-    std::for_each(policy,
-        query.plus_words.begin(), query.plus_words.end(),
-        [this, &document_predicate, &document_to_relevance](std::string_view word) {
-            if (word_to_document_freqs_.count(word)) {
-                const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-                for (const auto [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-                    const auto& document_data = documents_.at(document_id);
-                    if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                        document_to_relevance[document_id].ref_to_value += term_freq * inverse_document_freq;
+            bool is_excluded = false;
+            for (size_t k = 0; k < minus_cursors.size() && !is_excluded; ++k) {
+                const PostingList& postings = minus_postings[k]->by_status[status];
+                minus_cursors[k] = postings.Seek(minus_cursors[k], document_id);
+                is_excluded = minus_cursors[k] != postings.end() && minus_cursors[k]->document_id == document_id;
+            }
+            if (!is_excluded) {
+                if (IsDocumentAccepted(document_predicate, *driver_cursor, static_cast<DocumentStatus>(status))) {
+                    double relevance = 0.0;
+                    for (size_t k = 0; k < cursors.size(); ++k) {
+                        relevance += cursors[k]->term_freq * inverse_document_freqs[k];
                     }
+                    matched_documents.push_back({ document_id, relevance, driver_cursor->rating });
+                }
+                else {
+                    ++predicate_rejections;
                 }
             }
-        });
+            ++driver_cursor;
+        }
+    }
+    SEARCH_STATS_COUNT(POSTINGS_SCANNED, postings_scanned);
+    SEARCH_STATS_COUNT(PREDICATE_REJECTIONS, predicate_rejections);
+    SEARCH_STATS_COUNT(CANDIDATES, matched_documents.size());
+
+    // Keep the document id order FindAllDocuments produces when several partitions were walked
+    if (last_status - first_status > 1) {
+        std::sort(matched_documents.begin(), matched_documents.end(),
+            [](const Document& lhs, const Document& rhs) {
+                return lhs.id < rhs.id;
+            });
+    }
+    return matched_documents;
+}
 
-    std::map<int, double> document_to_relevance_reduced = document_to_relevance.BuildOrdinaryMap();
-    std::vector<Document> matched_documents;
-    matched_documents.reserve(document_to_relevance_reduced.size());
+template <typename DocumentPredicate>
+std::pair<size_t, size_t> SearchServer::GetStatusPartitions(const DocumentPredicate& document_predicate) {
+    if constexpr (std::is_same_v<DocumentPredicate, StatusFilter>) {
+        const size_t status = static_cast<size_t>(document_predicate.status);
+        return { status, status + 1 };
+    }
+    else {
+        return { 0, DOCUMENT_STATUS_COUNT };
+    }
+}
 
-    for (const auto [document_id, relevance] : document_to_relevance_reduced) {
-        matched_documents.push_back({ document_id, relevance, documents_.at(document_id).rating });
+template <typename DocumentPredicate>
+bool SearchServer::IsDocumentAccepted(DocumentPredicate& document_predicate, const PostingList::Posting& posting, DocumentStatus status) {
+    if constexpr (std::is_same_v<DocumentPredicate, StatusFilter>) {
+        // Only the partition of the filtered status is walked, see GetStatusPartitions
+        return true;
+    }
+    else if constexpr (std::is_invocable_r_v<bool, DocumentPredicate&, int>) {
+        return document_predicate(posting.document_id);
+    }
+    else {
+        return document_predicate(posting.document_id, status, posting.rating);
     }
-    return matched_documents;
 }
+
 void RemoveDuplicates(SearchServer& search_server);
 
@@ -0,0 +1,120 @@
+#include "search_stats.h"
+
+namespace {
+int GetBucketIndex(uint64_t value) {
+    int index = 0;
+    while (value != 0 && index < LatencyHistogram::BUCKET_COUNT - 1) {
+        value >>= 1;
+        ++index;
+    }
+    return index;
+}
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+    buckets_[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetCount() const {
+    return count_.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetSum() const {
+    return sum_.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetQuantile(double quantile) const {
+    const uint64_t count = GetCount();
+    if (count == 0) {
+        return 0;
+    }
+    const uint64_t rank = static_cast<uint64_t>(quantile * count + 0.5);
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank && seen > 0) {
+            return i == 0 ? 0 : (uint64_t(1) << i) - 1;
+        }
+    }
+    return UINT64_MAX;
+}
+
+SearchStats& SearchStats::Instance() {
+    static SearchStats stats;
+    return stats;
+}
+
+void SearchStats::RecordDuration(SearchStage stage, uint64_t nanoseconds) {
+    histograms_[static_cast<size_t>(stage)].Record(nanoseconds);
+}
+
+void SearchStats::AddCounter(SearchCounter counter, uint64_t value) {
+    counters_[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+const LatencyHistogram& SearchStats::GetHistogram(SearchStage stage) const {
+    return histograms_[static_cast<size_t>(stage)];
+}
+
+uint64_t SearchStats::GetCounter(SearchCounter counter) const {
+    return counters_[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+}
+
+void SearchStats::Reset() {
+    for (auto& histogram : histograms_) {
+        histogram.Reset();
+    }
+    for (auto& counter : counters_) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+void SearchStats::Print(std::ostream& out) const {
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        const auto& histogram = histograms_[i];
+        const char* name = GetStageName(static_cast<SearchStage>(i));
+        out << "search_stage_count{stage=\"" << name << "\"} " << histogram.GetCount() << '\n';
+        out << "search_stage_sum_ns{stage=\"" << name << "\"} " << histogram.GetSum() << '\n';
+        out << "search_stage_p50_ns{stage=\"" << name << "\"} " << histogram.GetQuantile(0.5) << '\n';
+        out << "search_stage_p99_ns{stage=\"" << name << "\"} " << histogram.GetQuantile(0.99) << '\n';
+    }
+    for (size_t i = 0; i < counters_.size(); ++i) {
+        out << "search_counter{name=\"" << GetCounterName(static_cast<SearchCounter>(i)) << "\"} "
+            << counters_[i].load(std::memory_order_relaxed) << '\n';
+    }
+}
+
+const char* GetStageName(SearchStage stage) {
+    switch (stage) {
+    case SearchStage::PARSE_QUERY: return "parse_query";
+    case SearchStage::POSTING_WALK: return "posting_walk";
+    case SearchStage::MINUS_FILTER: return "minus_filter";
+    case SearchStage::SORT: return "sort";
+    case SearchStage::BUILD_RESULT: return "build_result";
+    case SearchStage::FIND_TOP_DOCUMENTS: return "find_top_documents";
+    case SearchStage::MATCH_DOCUMENT: return "match_document";
+    case SearchStage::ADD_DOCUMENT: return "add_document";
+    case SearchStage::PROCESS_QUERIES: return "process_queries";
+    default: return "unknown";
+    }
+}
+
+const char* GetCounterName(SearchCounter counter) {
+    switch (counter) {
+    case SearchCounter::POSTINGS_SCANNED: return "postings_scanned";
+    case SearchCounter::CANDIDATES: return "candidates";
+    case SearchCounter::PREDICATE_REJECTIONS: return "predicate_rejections";
+    case SearchCounter::LOCK_WAITS: return "lock_waits";
+    default: return "unknown";
+    }
+}
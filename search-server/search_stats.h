@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+// Optional instrumentation of the search hot paths.
+// Build with -DSEARCH_SERVER_STATS to enable it; otherwise every
+// SEARCH_STATS_* macro expands to nothing and the code is compiled out.
+
+enum class SearchStage {
+    PARSE_QUERY,
+    POSTING_WALK,
+    MINUS_FILTER,
+    SORT,
+    BUILD_RESULT,
+    FIND_TOP_DOCUMENTS,
+    MATCH_DOCUMENT,
+    ADD_DOCUMENT,
+    PROCESS_QUERIES,
+    STAGE_COUNT,
+};
+
+enum class SearchCounter {
+    POSTINGS_SCANNED,
+    CANDIDATES,
+    PREDICATE_REJECTIONS,
+    LOCK_WAITS,
+    COUNTER_COUNT,
+};
+
+// Lock-free histogram with power-of-two buckets: bucket i holds samples in [2^(i-1), 2^i).
+class LatencyHistogram {
+public:
+    static const int BUCKET_COUNT = 64;
+
+    void Record(uint64_t value);
+    void Reset();
+
+    uint64_t GetCount() const;
+    uint64_t GetSum() const;
+    // Upper bound of the bucket containing the given quantile (0 < quantile <= 1)
+    uint64_t GetQuantile(double quantile) const;
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> count_{ 0 };
+    std::atomic<uint64_t> sum_{ 0 };
+};
+
+class SearchStats {
+public:
+    static SearchStats& Instance();
+
+    void RecordDuration(SearchStage stage, uint64_t nanoseconds);
+    void AddCounter(SearchCounter counter, uint64_t value);
+
+    const LatencyHistogram& GetHistogram(SearchStage stage) const;
+    uint64_t GetCounter(SearchCounter counter) const;
+
+    void Reset();
+    // One "name{label} value" line per metric, easy to read and to scrape
+    void Print(std::ostream& out) const;
+
+private:
+    SearchStats() = default;
+
+    std::array<LatencyHistogram, static_cast<size_t>(SearchStage::STAGE_COUNT)> histograms_;
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(SearchCounter::COUNTER_COUNT)> counters_{};
+};
+
+class ScopedStageTimer {
+public:
+    explicit ScopedStageTimer(SearchStage stage)
+        : stage_(stage)
+        , start_(std::chrono::steady_clock::now()) {
+    }
+
+    ~ScopedStageTimer() {
+        const auto duration = std::chrono::steady_clock::now() - start_;
+        SearchStats::Instance().RecordDuration(stage_,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    }
+
+private:
+    SearchStage stage_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+const char* GetStageName(SearchStage stage);
+const char* GetCounterName(SearchCounter counter);
+
+#define SEARCH_STATS_CONCAT_INTERNAL(X, Y) X##Y
+#define SEARCH_STATS_CONCAT(X, Y) SEARCH_STATS_CONCAT_INTERNAL(X, Y)
+
+#ifdef SEARCH_SERVER_STATS
+#define SEARCH_STATS_TIMER(stage) \
+    ScopedStageTimer SEARCH_STATS_CONCAT(stats_timer_, __LINE__)(SearchStage::stage)
+#define SEARCH_STATS_COUNT(counter, value) \
+    SearchStats::Instance().AddCounter(SearchCounter::counter, static_cast<uint64_t>(value))
+#else
+#define SEARCH_STATS_TIMER(stage)
+#define SEARCH_STATS_COUNT(counter, value) ((void)sizeof(value))
+#endif
@@ -1 +1,9 @@
 #pragma once
+
+// Cross-checks of the specialised search paths against plain FindTopDocuments.
+// A failed check prints the query and aborts
+void TestProcessQueries();
+void TestFindTopDocumentsAllWords();
+void TestSetDocumentStatus();
+
+void TestSearchServer();
@@ -1 +1,182 @@
 #include "test_exampe_functions.h"
+
+#include "process_queries.h"
+#include "search_server.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+void AssertImpl(bool value, const string& expr_str, const string& file, const string& func, unsigned line,
+    const string& hint) {
+    if (!value) {
+        cerr << file << "("s << line << "): "s << func << ": "s;
+        cerr << "ASSERT("s << expr_str << ") failed."s;
+        if (!hint.empty()) {
+            cerr << " Hint: "s << hint;
+        }
+        cerr << endl;
+        abort();
+    }
+}
+
+#define ASSERT_HINT(expr, hint) AssertImpl(!!(expr), #expr, __FILE__, __FUNCTION__, __LINE__, (hint))
+
+const int HUGE_DOCUMENT_ID = 2000000000;
+
+// Word b is in every 2nd document, c in every 3rd, d in every 7th and e only in the first
+// and the last one, so intersections skip gaps of different lengths. "a" is everywhere,
+// and "and" is a stop word
+string MakeTestText(int id) {
+    string text = "a"s;
+    if (id % 2 == 0) {
+        text += " b"s;
+    }
+    if (id % 3 == 0) {
+        text += " c"s;
+    }
+    if (id % 7 == 0) {
+        text += " d"s;
+    }
+    if (id == 0 || id == HUGE_DOCUMENT_ID) {
+        text += " e"s;
+    }
+    if (id % 5 == 0) {
+        text += " and a"s;
+    }
+    return text;
+}
+
+vector<int> MakeTestRatings(int id) {
+    return { id % 11 - 5, id % 3 };
+}
+
+// Statuses cycle, so every posting list is spread over all partitions. The huge id
+// checks that document ids are not used as indexes
+SearchServer MakeTestServer() {
+    SearchServer server("and"s);
+    for (int id = 0; id < 300; ++id) {
+        server.AddDocument(id, MakeTestText(id), static_cast<DocumentStatus>(id % DOCUMENT_STATUS_COUNT), MakeTestRatings(id));
+    }
+    server.AddDocument(HUGE_DOCUMENT_ID, MakeTestText(HUGE_DOCUMENT_ID), DocumentStatus::ACTUAL, MakeTestRatings(HUGE_DOCUMENT_ID));
+    return server;
+}
+
+// Same documents in the same order, with bit-identical relevance
+bool AreSameDocuments(const vector<Document>& lhs, const vector<Document>& rhs) {
+    return equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+        [](const Document& lhs_document, const Document& rhs_document) {
+            return lhs_document.id == rhs_document.id
+                && lhs_document.relevance == rhs_document.relevance
+                && lhs_document.rating == rhs_document.rating;
+        });
+}
+}
+
+void TestProcessQueries() {
+    const SearchServer server = MakeTestServer();
+    // Every combination of the words, some of them negated, including queries with no
+    // plus words and unknown words; more queries than one batch shard holds
+    const vector<string> words = { "a"s, "b"s, "c"s, "d"s, "e"s, "z"s, "and"s };
+    vector<string> queries;
+    for (int i = 0; i < 600; ++i) {
+        string query;
+        for (size_t w = 0; w < words.size(); ++w) {
+            if ((i >> w) & 1) {
+                query += (i * 7 + w) % 5 == 0 ? " -"s : " "s;
+                query += words[w];
+            }
+        }
+        queries.push_back(query);
+    }
+
+    const auto results = ProcessQueries(server, queries);
+    ASSERT_HINT(results.size() == queries.size(), "ProcessQueries answers every query"s);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        ASSERT_HINT(AreSameDocuments(results[i], server.FindTopDocuments(queries[i])), queries[i]);
+    }
+
+    const auto banned_results = server.FindTopDocumentsBatch(queries, DocumentStatus::BANNED);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        ASSERT_HINT(AreSameDocuments(banned_results[i], server.FindTopDocuments(queries[i], DocumentStatus::BANNED)), queries[i]);
+    }
+}
+
+void TestFindTopDocumentsAllWords() {
+    const SearchServer server = MakeTestServer();
+    // Query and the number of distinct plus words a document must contain
+    const vector<pair<string, size_t>> queries = {
+        { "a b"s, 2 }, { "b c"s, 2 }, { "c d"s, 2 }, { "b c d"s, 3 }, { "a e"s, 2 }, { "e d"s, 2 },
+        { "b c -d"s, 2 }, { "a b c d e"s, 5 }, { "d -e"s, 1 }, { "a z"s, 2 }, { "and b c"s, 2 },
+        { "b b c"s, 2 }, { "d"s, 1 }, { "-b"s, 0 },
+    };
+    for (const auto& [query, plus_word_count] : queries) {
+        const auto has_all_words = [&server, &query = query, plus_word_count = plus_word_count](int document_id) {
+            return plus_word_count > 0 && get<0>(server.MatchDocument(query, document_id)).size() == plus_word_count;
+        };
+
+        for (size_t status = 0; status < DOCUMENT_STATUS_COUNT; ++status) {
+            const auto document_status = static_cast<DocumentStatus>(status);
+            const auto expected = server.FindTopDocuments(query,
+                [&has_all_words, document_status](int document_id, DocumentStatus status, int rating) {
+                    return status == document_status && has_all_words(document_id);
+                });
+            ASSERT_HINT(AreSameDocuments(server.FindTopDocumentsAllWords(query, document_status), expected), query);
+        }
+
+        // Walks every status partition and merges them
+        const auto is_rated = [](int document_id, DocumentStatus status, int rating) {
+            return rating > 0;
+        };
+        const auto expected = server.FindTopDocuments(query,
+            [&has_all_words, &is_rated](int document_id, DocumentStatus status, int rating) {
+                return is_rated(document_id, status, rating) && has_all_words(document_id);
+            });
+        ASSERT_HINT(AreSameDocuments(server.FindTopDocumentsAllWords(query, is_rated), expected), query);
+    }
+}
+
+void TestSetDocumentStatus() {
+    SearchServer changed_server = MakeTestServer();
+    SearchServer readded_server = MakeTestServer();
+    // Includes a move to the status the document already has
+    const vector<pair<int, DocumentStatus>> changes = {
+        { 0, DocumentStatus::BANNED }, { 7, DocumentStatus::BANNED }, { 150, DocumentStatus::REMOVED },
+        { 2, DocumentStatus::BANNED }, { HUGE_DOCUMENT_ID, DocumentStatus::IRRELEVANT },
+    };
+    for (const auto& [document_id, status] : changes) {
+        changed_server.SetDocumentStatus(document_id, status);
+        readded_server.RemoveDocument(document_id);
+        readded_server.AddDocument(document_id, MakeTestText(document_id), status, MakeTestRatings(document_id));
+    }
+    ASSERT_HINT(changed_server.GetDocumentCount() == readded_server.GetDocumentCount(), "document count"s);
+
+    const auto is_rated = [](int document_id, DocumentStatus status, int rating) {
+        return rating > 0 && status != DocumentStatus::ACTUAL;
+    };
+    for (const string& query : { "a"s, "b c"s, "d -c"s, "e"s, "a b c d e"s }) {
+        for (size_t status = 0; status < DOCUMENT_STATUS_COUNT; ++status) {
+            const auto document_status = static_cast<DocumentStatus>(status);
+            ASSERT_HINT(AreSameDocuments(changed_server.FindTopDocuments(query, document_status),
+                readded_server.FindTopDocuments(query, document_status)), query);
+            ASSERT_HINT(AreSameDocuments(changed_server.FindTopDocumentsAllWords(query, document_status),
+                readded_server.FindTopDocumentsAllWords(query, document_status)), query);
+        }
+        ASSERT_HINT(AreSameDocuments(changed_server.FindTopDocuments(query, is_rated),
+            readded_server.FindTopDocuments(query, is_rated)), query);
+        for (const auto& [document_id, status] : changes) {
+            ASSERT_HINT(changed_server.MatchDocument(query, document_id) == readded_server.MatchDocument(query, document_id), query);
+        }
+    }
+}
+
+void TestSearchServer() {
+    TestProcessQueries();
+    TestFindTopDocumentsAllWords();
+    TestSetDocumentStatus();
+}
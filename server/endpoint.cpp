@@ -0,0 +1,112 @@
+#include "endpoint.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std::string_literals;
+
+namespace {
+[[noreturn]] void ThrowSystemError(const std::string& what) {
+    throw std::runtime_error(what + ": "s + std::strerror(errno));
+}
+
+sockaddr_un MakeUnixAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Unix socket path is too long: "s + path);
+    }
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    return address;
+}
+
+sockaddr_in MakeLoopbackAddress(int port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+}
+
+bool ParseEndpointArgument(const std::string& argument, Endpoint& endpoint) {
+    if (argument.rfind("--port="s, 0) == 0) {
+        endpoint.port = std::stoi(argument.substr(7));
+        return true;
+    }
+    if (argument.rfind("--unix="s, 0) == 0) {
+        endpoint.unix_path = argument.substr(7);
+        return true;
+    }
+    return false;
+}
+
+int ListenOn(const Endpoint& endpoint) {
+    const bool is_unix = !endpoint.unix_path.empty();
+    const int fd = socket(is_unix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        ThrowSystemError("socket"s);
+    }
+    int result = 0;
+    if (is_unix) {
+        unlink(endpoint.unix_path.c_str());
+        const sockaddr_un address = MakeUnixAddress(endpoint.unix_path);
+        result = bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    }
+    else {
+        const int enable = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        const sockaddr_in address = MakeLoopbackAddress(endpoint.port);
+        result = bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    }
+    if (result < 0 || listen(fd, SOMAXCONN) < 0) {
+        const int error = errno;
+        close(fd);
+        errno = error;
+        ThrowSystemError("bind/listen"s);
+    }
+    SetNonBlocking(fd);
+    return fd;
+}
+
+int ConnectTo(const Endpoint& endpoint) {
+    const bool is_unix = !endpoint.unix_path.empty();
+    const int fd = socket(is_unix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        ThrowSystemError("socket"s);
+    }
+    int result = 0;
+    if (is_unix) {
+        const sockaddr_un address = MakeUnixAddress(endpoint.unix_path);
+        result = connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    }
+    else {
+        const sockaddr_in address = MakeLoopbackAddress(endpoint.port);
+        result = connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        const int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    }
+    if (result < 0) {
+        const int error = errno;
+        close(fd);
+        errno = error;
+        ThrowSystemError("connect"s);
+    }
+    return fd;
+}
+
+void SetNonBlocking(int fd) {
+    const int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        ThrowSystemError("fcntl"s);
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+// Where the query service listens: a TCP port on localhost or a Unix socket path
+struct Endpoint {
+    int port = 0;
+    std::string unix_path;
+};
+
+// Parses "--port=N" or "--unix=PATH"; returns false for any other argument
+bool ParseEndpointArgument(const std::string& argument, Endpoint& endpoint);
+
+// Both throw std::runtime_error with errno text on failure
+int ListenOn(const Endpoint& endpoint);
+int ConnectTo(const Endpoint& endpoint);
+
+void SetNonBlocking(int fd);
@@ -0,0 +1,221 @@
+// Load generator for search_service: keeps a fixed number of pipelined queries
+// in flight on every connection and reports throughput and latency percentiles.
+
+#include "corpus_generator.h"
+#include "endpoint.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+struct ClientConfig {
+    Endpoint endpoint;
+    CorpusConfig corpus;
+    int connections = 4;
+    int requests = 10000;
+    int pipeline = 16;
+};
+
+struct ConnectionReport {
+    vector<uint64_t> latencies_ns;
+    int errors = 0;
+    // Exceptions cannot leave a thread, so main rethrows this after joining
+    exception_ptr failure;
+};
+
+void SendAll(int fd, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        const ssize_t count = send(fd, data.data() + sent, data.size() - sent, 0);
+        if (count <= 0) {
+            throw runtime_error("send failed"s);
+        }
+        sent += count;
+    }
+}
+
+// Reads until at least one full line is buffered and returns all complete lines
+vector<string> ReceiveLines(int fd, string& buffer) {
+    vector<string> lines;
+    while (lines.empty()) {
+        char chunk[16 * 1024];
+        const ssize_t count = recv(fd, chunk, sizeof(chunk), 0);
+        if (count <= 0) {
+            throw runtime_error("connection closed by server"s);
+        }
+        buffer.append(chunk, count);
+        size_t line_start = 0;
+        for (size_t line_end = buffer.find('\n'); line_end != string::npos; line_end = buffer.find('\n', line_start)) {
+            lines.push_back(buffer.substr(line_start, line_end - line_start));
+            line_start = line_end + 1;
+        }
+        buffer.erase(0, line_start);
+    }
+    return lines;
+}
+
+ConnectionReport RunConnection(const ClientConfig& config, const vector<string>& queries, int request_count, size_t query_offset) {
+    ConnectionReport report;
+    report.latencies_ns.reserve(request_count);
+    const int fd = ConnectTo(config.endpoint);
+    deque<chrono::steady_clock::time_point> in_flight;
+    string buffer;
+    int sent = 0;
+    int received = 0;
+    while (received < request_count) {
+        string batch;
+        while (sent < request_count && static_cast<int>(in_flight.size()) < config.pipeline) {
+            batch += "Q "s + queries[(query_offset + sent) % queries.size()] + '\n';
+            in_flight.push_back(chrono::steady_clock::now());
+            ++sent;
+        }
+        if (!batch.empty()) {
+            SendAll(fd, batch);
+        }
+        for (const string& line : ReceiveLines(fd, buffer)) {
+            const auto latency = chrono::steady_clock::now() - in_flight.front();
+            in_flight.pop_front();
+            report.latencies_ns.push_back(chrono::duration_cast<chrono::nanoseconds>(latency).count());
+            if (line.rfind("OK"s, 0) != 0) {
+                ++report.errors;
+            }
+            ++received;
+        }
+    }
+    close(fd);
+    return report;
+}
+
+string RequestStats(const Endpoint& endpoint) {
+    const int fd = ConnectTo(endpoint);
+    SendAll(fd, "S\n"s);
+    string buffer;
+    const string line = ReceiveLines(fd, buffer).front();
+    close(fd);
+    return line;
+}
+
+uint64_t GetPercentile(const vector<uint64_t>& sorted, double percentile) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    const size_t index = min(sorted.size() - 1, static_cast<size_t>(percentile * sorted.size()));
+    return sorted[index];
+}
+
+bool ParseArgument(const string& argument, ClientConfig& config) {
+    if (ParseEndpointArgument(argument, config.endpoint)) {
+        return true;
+    }
+    const auto separator = argument.find('=');
+    if (argument.rfind("--"s, 0) != 0 || separator == string::npos) {
+        return false;
+    }
+    const string key = argument.substr(2, separator - 2);
+    const string value = argument.substr(separator + 1);
+    if (key == "connections"s) {
+        config.connections = max(1, stoi(value));
+    }
+    else if (key == "requests"s) {
+        config.requests = max(1, stoi(value));
+    }
+    else if (key == "pipeline"s) {
+        config.pipeline = max(1, stoi(value));
+    }
+    else if (key == "queries"s) {
+        config.corpus.query_count = max(1, stoi(value));
+    }
+    else if (key == "query-words"s) {
+        config.corpus.words_per_query = stoi(value);
+    }
+    else if (key == "vocabulary"s) {
+        config.corpus.vocabulary_size = stoi(value);
+    }
+    else if (key == "seed"s) {
+        config.corpus.seed = static_cast<uint32_t>(stoul(value));
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+}
+
+int main(int argc, char* argv[]) {
+    ClientConfig config;
+    for (int i = 1; i < argc; ++i) {
+        if (!ParseArgument(argv[i], config)) {
+            cerr << "Unknown argument: "s << argv[i] << '\n'
+                << "Usage: "s << argv[0] << " (--port=N | --unix=PATH) [--connections=N] [--requests=N]"s
+                << " [--pipeline=N] [--queries=N] [--query-words=N] [--vocabulary=N] [--seed=N]\n"s;
+            return EXIT_FAILURE;
+        }
+    }
+    if (config.endpoint.port == 0 && config.endpoint.unix_path.empty()) {
+        cerr << "Either --port or --unix is required\n"s;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        const auto queries = GenerateQueries(config.corpus, GenerateVocabulary(config.corpus.vocabulary_size));
+        vector<ConnectionReport> reports(config.connections);
+        vector<thread> threads;
+        const auto start = chrono::steady_clock::now();
+        for (int i = 0; i < config.connections; ++i) {
+            // Requests are spread evenly, the first connections take the remainder
+            const int request_count = config.requests / config.connections + (i < config.requests % config.connections ? 1 : 0);
+            threads.emplace_back([&config, &queries, &reports, i, request_count] {
+                try {
+                    reports[i] = RunConnection(config, queries, request_count, static_cast<size_t>(i) * 7919);
+                }
+                catch (...) {
+                    reports[i].failure = current_exception();
+                }
+            });
+        }
+        for (thread& worker : threads) {
+            worker.join();
+        }
+        for (const ConnectionReport& report : reports) {
+            if (report.failure) {
+                rethrow_exception(report.failure);
+            }
+        }
+        const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        vector<uint64_t> latencies;
+        int errors = 0;
+        for (const ConnectionReport& report : reports) {
+            latencies.insert(latencies.end(), report.latencies_ns.begin(), report.latencies_ns.end());
+            errors += report.errors;
+        }
+        sort(latencies.begin(), latencies.end());
+
+        cout << "requests="s << latencies.size()
+            << " errors="s << errors
+            << " seconds="s << seconds
+            << " qps="s << latencies.size() / seconds
+            << " p50_us="s << GetPercentile(latencies, 0.50) / 1000
+            << " p99_us="s << GetPercentile(latencies, 0.99) / 1000
+            << " max_us="s << (latencies.empty() ? 0 : latencies.back() / 1000) << '\n';
+        cout << RequestStats(config.endpoint) << '\n';
+    }
+    catch (const exception& error) {
+        cerr << error.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
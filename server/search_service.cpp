@@ -0,0 +1,436 @@
+// Query service over a local socket.
+//
+// Protocol: one request per line, one response line per request, in order.
+//   Q <query>  ->  OK <id>:<relevance>:<rating> ...   (best documents, may be empty)
+//                  ERR <message>                       (invalid query)
+//   S          ->  STATS no_result_requests=<n>       (RequestQueue statistics)
+// Queries arriving within the batch window are answered together through
+// SearchServer::FindTopDocumentsBatch.
+
+#include "corpus_generator.h"
+#include "corpus_loader.h"
+#include "endpoint.h"
+#include "request_queue.h"
+#include "search_server.h"
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+const size_t MAX_LINE_LENGTH = 64 * 1024;
+
+struct ServiceConfig {
+    Endpoint endpoint;
+    CorpusConfig corpus;
+    // Document dump to serve; a synthetic corpus is generated when empty
+    string corpus_path;
+    // Space-separated stop words; by default none for a dump and the most frequent
+    // vocabulary words for a synthetic corpus
+    optional<string> stop_words;
+    size_t batch_size = 256;
+    int batch_window_ms = 1;
+};
+
+struct Connection {
+    int fd = -1;
+    string input;
+    string output;
+    // Queries waiting in the batch; a half-closed connection stays open until they are answered
+    size_t pending_queries = 0;
+    bool is_read_closed = false;
+};
+
+struct PendingQuery {
+    uint64_t connection_id;
+    string query;
+};
+
+class SearchService {
+public:
+    SearchService(const ServiceConfig& config, const SearchServer& search_server)
+        : config_(config)
+        , search_server_(search_server)
+        , request_queue_(search_server)
+        , listen_fd_(ListenOn(config.endpoint))
+        , epoll_fd_(epoll_create1(0))
+    {
+        if (epoll_fd_ < 0) {
+            throw runtime_error("epoll_create1 failed"s);
+        }
+        Watch(listen_fd_, EPOLLIN, LISTENER_ID);
+    }
+
+    ~SearchService() {
+        for (auto& [id, connection] : connections_) {
+            close(connection.fd);
+        }
+        close(epoll_fd_);
+        close(listen_fd_);
+    }
+
+    void Run() {
+        vector<epoll_event> events(256);
+        while (true) {
+            const int ready = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), GetTimeout());
+            if (ready < 0 && errno != EINTR) {
+                throw runtime_error("epoll_wait failed"s);
+            }
+            for (int i = 0; i < ready; ++i) {
+                const uint64_t id = events[i].data.u64;
+                if (id == LISTENER_ID) {
+                    AcceptConnections();
+                    continue;
+                }
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    ReadFrom(id);
+                }
+                if (events[i].events & EPOLLOUT) {
+                    WriteTo(id);
+                }
+            }
+            if (!pending_.empty() && (pending_.size() >= config_.batch_size
+                || chrono::steady_clock::now() - batch_start_ >= chrono::milliseconds(config_.batch_window_ms))) {
+                ExecuteBatch();
+            }
+            FlushResponses();
+        }
+    }
+
+private:
+    static const uint64_t LISTENER_ID = 0;
+
+    const ServiceConfig& config_;
+    const SearchServer& search_server_;
+    RequestQueue request_queue_;
+    int listen_fd_;
+    int epoll_fd_;
+    uint64_t next_connection_id_ = LISTENER_ID + 1;
+    map<uint64_t, Connection> connections_;
+    vector<PendingQuery> pending_;
+    // Connections with responses not yet handed to the socket
+    set<uint64_t> unflushed_;
+    chrono::steady_clock::time_point batch_start_;
+
+    void Watch(int fd, uint32_t events, uint64_t id, int operation = EPOLL_CTL_ADD) {
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = id;
+        epoll_ctl(epoll_fd_, operation, fd, &event);
+    }
+
+    int GetTimeout() const {
+        if (pending_.empty()) {
+            return -1;
+        }
+        const auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - batch_start_);
+        return max(0, config_.batch_window_ms - static_cast<int>(elapsed.count()));
+    }
+
+    void AcceptConnections() {
+        while (true) {
+            const int fd = accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) {
+                return;
+            }
+            SetNonBlocking(fd);
+            const int enable = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+            const uint64_t id = next_connection_id_++;
+            connections_[id].fd = fd;
+            Watch(fd, EPOLLIN, id);
+        }
+    }
+
+    // Queries of the connection still waiting in the batch are dropped, so they are neither run nor counted
+    void CloseConnection(uint64_t id) {
+        const auto iter = connections_.find(id);
+        if (iter == connections_.end()) {
+            return;
+        }
+        close(iter->second.fd);
+        connections_.erase(iter);
+        pending_.erase(remove_if(pending_.begin(), pending_.end(),
+            [id](const PendingQuery& pending) {
+                return pending.connection_id == id;
+            }), pending_.end());
+    }
+
+    // Closes a half-closed connection once all its responses are written, otherwise
+    // watches the events it still needs
+    void UpdateConnection(uint64_t id) {
+        const auto iter = connections_.find(id);
+        if (iter == connections_.end()) {
+            return;
+        }
+        Connection& connection = iter->second;
+        if (connection.is_read_closed && connection.pending_queries == 0 && connection.output.empty()) {
+            CloseConnection(id);
+            return;
+        }
+        uint32_t events = connection.is_read_closed ? 0 : EPOLLIN;
+        if (!connection.output.empty()) {
+            events |= EPOLLOUT;
+        }
+        Watch(connection.fd, events, id, EPOLL_CTL_MOD);
+    }
+
+    void ReadFrom(uint64_t id) {
+        const auto iter = connections_.find(id);
+        if (iter == connections_.end()) {
+            return;
+        }
+        Connection& connection = iter->second;
+        if (connection.is_read_closed) {
+            return;
+        }
+        char buffer[16 * 1024];
+        bool is_failed = false;
+        while (true) {
+            const ssize_t count = read(connection.fd, buffer, sizeof(buffer));
+            if (count > 0) {
+                connection.input.append(buffer, count);
+                continue;
+            }
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            // End of input still gets answers to the queries already sent
+            connection.is_read_closed = count == 0;
+            is_failed = count < 0 && errno != EAGAIN && errno != EWOULDBLOCK;
+            break;
+        }
+
+        vector<string> lines;
+        size_t line_start = 0;
+        for (size_t line_end = connection.input.find('\n'); line_end != string::npos;
+            line_end = connection.input.find('\n', line_start)) {
+            lines.push_back(connection.input.substr(line_start, line_end - line_start));
+            if (lines.back().size() > 0 && lines.back().back() == '\r') {
+                lines.back().pop_back();
+            }
+            line_start = line_end + 1;
+        }
+        connection.input.erase(0, line_start);
+        if (connection.input.size() > MAX_LINE_LENGTH) {
+            is_failed = true;
+        }
+        if (is_failed) {
+            CloseConnection(id);
+            return;
+        }
+
+        // Handling a line may run a batch, so only the id is used from here on
+        for (string& line : lines) {
+            HandleLine(id, move(line));
+        }
+        UpdateConnection(id);
+    }
+
+    void HandleLine(uint64_t id, string line) {
+        if (line.rfind("Q "s, 0) == 0) {
+            if (pending_.empty()) {
+                batch_start_ = chrono::steady_clock::now();
+            }
+            pending_.push_back({ id, line.substr(2) });
+            ++connections_.at(id).pending_queries;
+            return;
+        }
+        // Any other request is answered after the queries before it, so the batch goes first
+        if (!pending_.empty()) {
+            ExecuteBatch();
+        }
+        if (line == "S"s) {
+            Respond(id, "STATS no_result_requests="s + to_string(request_queue_.GetNoResultRequests()));
+        }
+        else {
+            Respond(id, "ERR unknown command"s);
+        }
+    }
+
+    void ExecuteBatch() {
+        vector<string> queries;
+        queries.reserve(pending_.size());
+        for (const PendingQuery& pending : pending_) {
+            queries.push_back(pending.query);
+        }
+
+        vector<vector<Document>> results;
+        vector<string> errors(queries.size());
+        try {
+            results = search_server_.FindTopDocumentsBatch(queries);
+        }
+        catch (const invalid_argument&) {
+            // One bad query fails the whole batch; answer the queries one by one instead
+            results.assign(queries.size(), {});
+            for (size_t i = 0; i < queries.size(); ++i) {
+                try {
+                    results[i] = search_server_.FindTopDocuments(queries[i]);
+                }
+                catch (const invalid_argument& error) {
+                    errors[i] = error.what();
+                }
+            }
+        }
+
+        for (size_t i = 0; i < pending_.size(); ++i) {
+            --connections_.at(pending_[i].connection_id).pending_queries;
+            if (!errors[i].empty()) {
+                Respond(pending_[i].connection_id, "ERR "s + errors[i]);
+                continue;
+            }
+            request_queue_.AddRequest(static_cast<int>(results[i].size()));
+            ostringstream response;
+            response << "OK"s;
+            for (const Document& document : results[i]) {
+                response << ' ' << document.id << ':' << document.relevance << ':' << document.rating;
+            }
+            Respond(pending_[i].connection_id, response.str());
+        }
+        pending_.clear();
+    }
+
+    void Respond(uint64_t id, const string& response) {
+        const auto iter = connections_.find(id);
+        if (iter == connections_.end()) {
+            return;
+        }
+        iter->second.output += response;
+        iter->second.output += '\n';
+        unflushed_.insert(id);
+    }
+
+    void FlushResponses() {
+        for (const uint64_t id : unflushed_) {
+            WriteTo(id);
+        }
+        unflushed_.clear();
+    }
+
+    void WriteTo(uint64_t id) {
+        const auto iter = connections_.find(id);
+        if (iter == connections_.end()) {
+            return;
+        }
+        Connection& connection = iter->second;
+        size_t written = 0;
+        while (written < connection.output.size()) {
+            const ssize_t count = write(connection.fd, connection.output.data() + written, connection.output.size() - written);
+            if (count > 0) {
+                written += count;
+                continue;
+            }
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            CloseConnection(id);
+            return;
+        }
+        connection.output.erase(0, written);
+        UpdateConnection(id);
+    }
+};
+
+bool ParseArgument(const string& argument, ServiceConfig& config) {
+    if (ParseEndpointArgument(argument, config.endpoint)) {
+        return true;
+    }
+    const auto separator = argument.find('=');
+    if (argument.rfind("--"s, 0) != 0 || separator == string::npos) {
+        return false;
+    }
+    const string key = argument.substr(2, separator - 2);
+    const string value = argument.substr(separator + 1);
+    if (key == "corpus"s) {
+        config.corpus_path = value;
+    }
+    else if (key == "stop-words"s) {
+        config.stop_words = value;
+    }
+    else if (key == "documents"s) {
+        config.corpus.document_count = stoi(value);
+    }
+    else if (key == "vocabulary"s) {
+        config.corpus.vocabulary_size = stoi(value);
+    }
+    else if (key == "document-words"s) {
+        config.corpus.words_per_document = stoi(value);
+    }
+    else if (key == "seed"s) {
+        config.corpus.seed = static_cast<uint32_t>(stoul(value));
+    }
+    else if (key == "batch-size"s) {
+        config.batch_size = max(1, stoi(value));
+    }
+    else if (key == "batch-window-ms"s) {
+        config.batch_window_ms = max(0, stoi(value));
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+}
+
+int main(int argc, char* argv[]) {
+    ServiceConfig config;
+    for (int i = 1; i < argc; ++i) {
+        if (!ParseArgument(argv[i], config)) {
+            cerr << "Unknown argument: "s << argv[i] << '\n'
+                << "Usage: "s << argv[0] << " (--port=N | --unix=PATH) [--corpus=FILE] [--stop-words=WORDS] [--documents=N] [--vocabulary=N]"s
+                << " [--document-words=N] [--seed=N] [--batch-size=N] [--batch-window-ms=N]\n"s;
+            return EXIT_FAILURE;
+        }
+    }
+    if (config.endpoint.port == 0 && config.endpoint.unix_path.empty()) {
+        cerr << "Either --port or --unix is required\n"s;
+        return EXIT_FAILURE;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    try {
+        vector<string> vocabulary;
+        if (config.corpus_path.empty()) {
+            vocabulary = GenerateVocabulary(config.corpus.vocabulary_size);
+        }
+        SearchServer search_server(config.stop_words.value_or(GenerateStopWords(vocabulary, 10)));
+        if (!config.corpus_path.empty()) {
+            LoadDocuments(search_server, config.corpus_path);
+        }
+        else {
+            for (const auto& document : GenerateDocuments(config.corpus, vocabulary)) {
+                search_server.AddDocument(document.id, document.text, document.status, document.ratings);
+            }
+        }
+        cerr << "Indexed "s << search_server.GetDocumentCount() << " documents, serving\n"s;
+
+        SearchService service(config, search_server);
+        service.Run();
+    }
+    catch (const exception& error) {
+        cerr << error.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}